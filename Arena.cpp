@@ -0,0 +1,93 @@
+#include "Arena.h"
+
+void* ScratchArena::allocate(size_t bytes, size_t align)
+{
+	if (bytes == 0)
+		bytes = 1;
+	if (current < blocks.size()) {
+		Block& b = blocks[current];
+		size_t start = (reinterpret_cast<quintptr>(b.data) + used + align - 1) / align * align - reinterpret_cast<quintptr>(b.data);
+		if (start + bytes <= b.size) {
+			used = start + bytes;
+			return b.data + start;
+		}
+	}
+	//dalsi volny blok, ktory staci, sa presunie hned za aktualny, inak sa alokuje novy
+	int dalsi = blocks.isEmpty() ? 0 : current + 1;
+	int k;
+	for (k = dalsi; k < blocks.size(); k++)
+		if (blocks[k].size >= bytes + align)
+			break;
+	if (k == blocks.size()) {
+		size_t size = qMax(blockSize, bytes + align);
+		Block b = { static_cast<char*>(::operator new(size)), size };
+		blocks.append(b);
+	}
+	qSwap(blocks[dalsi], blocks[k]);
+	current = dalsi;
+	used = 0;
+	return allocate(bytes, align);
+}
+
+void ScratchArena::release()
+{
+	for (Block& b : blocks)
+		::operator delete(b.data);
+	blocks.clear();
+	current = 0;
+	used = 0;
+}
+
+void ScratchArena::trim(size_t limit)
+{
+	size_t kapacita = 0;
+	int k;
+	for (k = 0; k < blocks.size() && (k <= current || kapacita + blocks[k].size <= limit); k++)
+		kapacita += blocks[k].size;
+	for (int i = k; i < blocks.size(); i++)
+		::operator delete(blocks[i].data);
+	blocks.resize(k);
+}
+
+size_t ScratchArena::getCapacity() const
+{
+	size_t kapacita = 0;
+	for (const Block& b : blocks)
+		kapacita += b.size;
+	return kapacita;
+}
+
+size_t ScratchArena::getUsed() const
+{
+	size_t obsadene = used;
+	for (int k = 0; k < current && k < blocks.size(); k++)
+		obsadene += blocks[k].size;
+	return obsadene;
+}
+
+ScratchArena::Scope::~Scope()
+{
+	arena.current = current;
+	arena.used = used;
+	if (--arena.depth == 0)
+		arena.trim(retainLimit);
+}
+
+ScratchArena& ScratchArena::forThread()
+{
+	static thread_local ScratchArena arena;
+	return arena;
+}
+
+ArenaHash::ArenaHash(ScratchArena& arena, int n)
+{
+	quint64 kapacita = 16;
+	shift = 60;
+	while (kapacita < 2 * quint64(qMax(n, 1))) {
+		kapacita *= 2;
+		shift--;
+	}
+	mask = kapacita - 1;
+	keys = arena.allocFilled<quint64>(kapacita, emptyKey);
+	values = arena.alloc<int>(kapacita);
+}
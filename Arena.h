@@ -0,0 +1,98 @@
+#pragma once
+#include <QtCore>
+#include <cstddef>
+#include <type_traits>
+
+// bump alokator pre docasne polia jednej operacie nad sietou (parovanie, delenie, generovanie)
+// alokacia je posun ukazovatela v bloku, uvolnenie naraz cez Scope alebo reset() v O(1)
+// bloky zostavaju pre dalsiu operaciu, takze opakovana operacia po zahriati nealokuje
+// v arene mozu byt len typy bez destruktora (int, double, ...)
+class ScratchArena {
+	struct Block {
+		char* data;
+		size_t size;
+	};
+	QVector<Block> blocks;
+	int current = 0;		// blok, z ktoreho sa alokuje
+	size_t used = 0;		// obsadene bajty v bloku current
+	size_t blockSize;
+	int depth = 0;			// pocet otvorenych Scope
+public:
+	static const size_t defaultBlockSize = 1 << 20;
+	// po skonceni vonkajsieho Scope sa nad tuto kapacitu bloky vratia systemu
+	static const size_t retainLimit = 64 << 20;
+
+	explicit ScratchArena(size_t block = defaultBlockSize) : blockSize(block) {};
+	~ScratchArena() { release(); };
+	ScratchArena(const ScratchArena&) = delete;
+	ScratchArena& operator=(const ScratchArena&) = delete;
+
+	void* allocate(size_t bytes, size_t align = alignof(std::max_align_t));
+	template <typename T> T* alloc(size_t n) {
+		static_assert(std::is_trivially_destructible<T>::value, "ScratchArena nevola destruktory");
+		return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+	};
+	template <typename T> T* allocFilled(size_t n, T value) {
+		T* p = alloc<T>(n);
+		std::fill(p, p + n, value);
+		return p;
+	};
+
+	// vsetko alokovane je neplatne, bloky zostanu
+	void reset() { current = 0; used = 0; };
+	// vrati systemu vsetky bloky
+	void release();
+	// vrati systemu bloky nad limit kapacity (len nepouzivane)
+	void trim(size_t limit);
+	size_t getCapacity() const;
+	size_t getUsed() const;
+
+	// alokacie v ramci Scope sa na jeho konci uvolnia, Scope sa mozu vnarat
+	class Scope {
+		ScratchArena& arena;
+		int current;
+		size_t used;
+	public:
+		explicit Scope(ScratchArena& a) : arena(a), current(a.current), used(a.used) { arena.depth++; };
+		~Scope();
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+
+	// arena aktualneho vlakna (GUI, QThreadPool), uvolni sa s vlaknom
+	static ScratchArena& forThread();
+};
+
+// hashovacia tabulka s otvorenym adresovanim (kluc quint64 -> int) v pamati areny
+// kapacita je pevna (mocnina 2 aspon 2n), kluc emptyKey sa nesmie vlozit
+class ArenaHash {
+	quint64* keys;
+	int* values;
+	quint64 mask;
+	int shift;
+
+	quint64 slot(quint64 key) const { return (key * 0x9E3779B97F4A7C15ULL) >> shift; };
+public:
+	static const quint64 emptyKey = ~quint64(0);
+	ArenaHash(ScratchArena& arena, int n);
+
+	// hodnota pre kluc, ak kluc nie je v tabulke, vlozi ho s hodnotou value
+	int& insert(quint64 key, int value) {
+		quint64 i = slot(key);
+		while (keys[i] != key) {
+			if (keys[i] == emptyKey) {
+				keys[i] = key;
+				values[i] = value;
+				break;
+			}
+			i = (i + 1) & mask;
+		}
+		return values[i];
+	};
+	int value(quint64 key, int notFound) const {
+		for (quint64 i = slot(key); keys[i] != emptyKey; i = (i + 1) & mask)
+			if (keys[i] == key)
+				return values[i];
+		return notFound;
+	};
+};
@@ -0,0 +1,191 @@
+#include "Batch.h"
+#include "MeshIO.h"
+#include "Subdivision.h"
+#include "Trace.h"
+#include "Weld.h"
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#if defined(_MSC_VER)
+#pragma comment(lib, "psapi.lib")
+#endif
+#else
+#include <sys/resource.h>
+#endif
+
+static const char* const batchOptions[] = { "--generate", "--import", "--subdivide", "--export" };
+
+bool isBatchMode(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++) {
+		for (const char* o : batchOptions) {
+			size_t n = strlen(o);
+			if (strncmp(argv[i], o, n) == 0 && (argv[i][n] == '\0' || argv[i][n] == '='))
+				return true;
+		}
+	}
+	return false;
+}
+
+qint64 peakResidentBytes()
+{
+#if defined(Q_OS_WIN)
+	PROCESS_MEMORY_COUNTERS pmc;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+		return qint64(pmc.PeakWorkingSetSize);
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#if defined(Q_OS_MACOS)
+	return qint64(usage.ru_maxrss);
+#else
+	return qint64(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+// jeden riadok vystupu: nazov kroku, cas, velkost siete (aj do zaznamu --trace)
+static void printStage(QTextStream& out, QString stage, qint64 nsec, const Hedron& mesh)
+{
+	Trace::counter("mesh V", mesh.getVrcholysize());
+	Trace::counter("mesh H", mesh.getHranysize());
+	Trace::counter("mesh F", mesh.getStenysize());
+	out << QString("%1 %2 ms  V=%3 H=%4 F=%5").arg(stage, -16).arg(nsec / 1e6, 10, 'f', 2)
+		.arg(mesh.getVrcholysize()).arg(mesh.getHranysize()).arg(mesh.getStenysize()) << "\n";
+	out.flush();
+}
+
+int runBatch(const QStringList& arguments)
+{
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Davkove spracovanie siete bez okna.");
+	parser.addHelpOption();
+	QCommandLineOption generateOption("generate", "Vytvori teleso <shape> (octa).", "shape");
+	QCommandLineOption importOption("import", "Nacita siet zo suboru VTK alebo .hed.", "file");
+	QCommandLineOption subdivideOption("subdivide", "Rozdeli siet <n>-krat.", "n", "0");
+	QCommandLineOption exportOption("export", "Ulozi siet, format podla pripony (.hed, inak VTK).", "file");
+	QCommandLineOption binaryOption("binary", "VTK export v binarnom tvare.");
+	QCommandLineOption threadsOption("threads", "Pocet vlakien pri deleni.", "n", QString::number(QThread::idealThreadCount()));
+	QCommandLineOption traceOption("trace", "Zaznam casov krokov ako Chrome trace JSON.", "file");
+	QCommandLineOption weldOption("weld", "Pred delenim zvari vrcholy blizsie ako <tolerance>.", "tolerance");
+	parser.addOptions({ generateOption, importOption, subdivideOption, exportOption, binaryOption, threadsOption, traceOption, weldOption });
+
+	QTextStream out(stdout), err(stderr);
+	if (!parser.parse(arguments)) {
+		err << parser.errorText() << "\n";
+		return 2;
+	}
+	if (parser.isSet("help")) {
+		out << parser.helpText();
+		return 0;
+	}
+
+	bool ok;
+	int levels = parser.value(subdivideOption).toInt(&ok);
+	if (!ok || levels < 0) {
+		err << "Neplatny pocet deleni: " << parser.value(subdivideOption) << "\n";
+		return 2;
+	}
+	int threads = parser.value(threadsOption).toInt(&ok);
+	if (!ok || threads < 1) {
+		err << "Neplatny pocet vlakien: " << parser.value(threadsOption) << "\n";
+		return 2;
+	}
+	double tolerance = 0;
+	if (parser.isSet(weldOption)) {
+		tolerance = parser.value(weldOption).toDouble(&ok);
+		if (!ok || !(tolerance > 0)) {
+			err << "Neplatna tolerancia zvarania: " << parser.value(weldOption) << "\n";
+			return 2;
+		}
+	}
+	if (parser.isSet(generateOption) == parser.isSet(importOption)) {
+		err << "Zadajte prave jednu z volieb --generate a --import.\n";
+		return 2;
+	}
+	if (parser.isSet(generateOption) && parser.value(generateOption) != "octa") {
+		err << "Neznamy tvar: " << parser.value(generateOption) << " (podporovany je octa)\n";
+		return 2;
+	}
+
+	//zaznam sa zapise aj po chybe, ukaze, kde sa skoncilo
+	Trace::setEnabled(parser.isSet(traceOption));
+	auto koniec = [&](int code) {
+		QString error;
+		if (parser.isSet(traceOption) && !Trace::exportChrome(parser.value(traceOption), &error)) {
+			err << parser.value(traceOption) << ": " << error << "\n";
+			return code == 0 ? 1 : code;
+		}
+		return code;
+	};
+
+	Hedron mesh;
+	QString error;
+	QElapsedTimer timer, total;
+	total.start();
+
+	timer.start();
+	if (parser.isSet(generateOption)) {
+		mesh = geodesicSphere(0, &error);
+		if (mesh.HisEmpty()) {
+			err << error << "\n";
+			return koniec(1);
+		}
+		printStage(out, "generate", timer.nsecsElapsed(), mesh);
+	}
+	else {
+		mesh = importMesh(parser.value(importOption), &error);
+		if (mesh.HisEmpty()) {
+			err << parser.value(importOption) << ": " << error << "\n";
+			return koniec(1);
+		}
+		printStage(out, "import", timer.nsecsElapsed(), mesh);
+		if (mesh.getBoundaryCount() > 0 || mesh.getNonManifoldCount() > 0)
+			out << QString("hranicne polohrany %1, nemanifoldne polohrany %2").arg(mesh.getBoundaryCount()).arg(mesh.getNonManifoldCount()) << "\n";
+	}
+
+	if (parser.isSet(weldOption)) {
+		timer.start();
+		WeldResult zvarene;
+		mesh = weldMesh(mesh, tolerance, &error, nullptr, &zvarene);
+		if (mesh.HisEmpty()) {
+			err << error << "\n";
+			return koniec(1);
+		}
+		printStage(out, "weld", timer.nsecsElapsed(), mesh);
+		out << QString("%1 zvarenych vrcholov, %2 odstranenych stien").arg(zvarene.removedVertices).arg(zvarene.removedFaces) << "\n";
+	}
+
+	SubdivisionEngine engine(threads);
+	for (int i = 1; i <= levels; i++) {
+		timer.start();
+		mesh = engine.subdivide(mesh, &error);
+		if (mesh.HisEmpty()) {
+			err << error << "\n";
+			return koniec(1);
+		}
+		printStage(out, QString("subdivide %1/%2").arg(i).arg(levels), timer.nsecsElapsed(), mesh);
+	}
+
+	if (parser.isSet(exportOption)) {
+		QString fileName = parser.value(exportOption);
+		qint64 bytes = 0;
+		timer.start();
+		bool toNative = QFileInfo(fileName).suffix().toLower() == "hed";
+		ok = toNative ? exportNative(mesh, fileName, &error, &bytes) : exportVtk(mesh, fileName, parser.isSet(binaryOption), &error, &bytes);
+		if (!ok) {
+			err << fileName << ": " << error << "\n";
+			return koniec(1);
+		}
+		printStage(out, "export", timer.nsecsElapsed(), mesh);
+		out << QString("%1 B zapisanych do %2").arg(bytes).arg(fileName) << "\n";
+	}
+
+	out << QString("%1 %2 ms").arg("total", -16).arg(total.nsecsElapsed() / 1e6, 10, 'f', 2) << "\n";
+	out << QString("peak RSS %1 MB").arg(peakResidentBytes() / (1024.0 * 1024.0), 0, 'f', 1) << "\n";
+	Trace::counter("peak RSS", peakResidentBytes());
+	return koniec(0);
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <QtCore>
+
+// davkovy rezim bez okna: generovanie / import, delenie a export siete z prikazoveho riadku
+// napr. --generate octa --subdivide 7 --export sphere.vtk alebo --import in.vtk --export out.hed
+// pre kazdy krok vypise cas a velkost siete, na konci maximalnu pouzitu pamat (peak RSS)
+// --trace out.json zapise casy krokov a faz (Trace) ako Chrome trace
+// --weld 1e-6 pred delenim zvari zdvojene vrcholy (Weld)
+
+// true, ak argumenty obsahuju niektoru z volieb davkoveho rezimu (vtedy sa nevytvara QApplication)
+bool isBatchMode(int argc, char* argv[]);
+// spracuje argumenty a spusti kroky, vrati navratovy kod programu
+int runBatch(const QStringList& arguments);
+
+// maximalna velkost pamate procesu v bajtoch, 0 ak ju system nevie zistit
+qint64 peakResidentBytes();
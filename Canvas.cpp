@@ -0,0 +1,254 @@
+#include "Canvas.h"
+#include <QtConcurrent>
+
+void TiledCanvas::reset(QSize s, QRgb fill, QSharedPointer<const ImageSource> src)
+{
+	size = s.isValid() ? s : QSize(0, 0);
+	source = src;
+	fillColor = fill;
+	tilesX = (size.width() + tileSize - 1) / tileSize;
+	tilesY = (size.height() + tileSize - 1) / tileSize;
+	tiles.clear();
+	tiles.resize(tilesX * tilesY);
+	allocated.clear();
+	recording = false;
+	record = Record();
+	recorded.clear();
+	recorded.resize(tiles.size());
+}
+
+void TiledCanvas::clear(QRgb fill)
+{
+	for (int t : allocated) {
+		recordTile(t);
+		tiles[t] = QImage();
+	}
+	allocated.clear();
+	source.reset();
+	fillColor = fill;
+}
+
+bool TiledCanvas::setSource(QSharedPointer<const ImageSource> src)
+{
+	if (src && src->size() != size)
+		return false;
+	source = src;
+	return true;
+}
+
+void TiledCanvas::beginRecord()
+{
+	recording = true;
+	recordStamp++;
+	record = Record();
+	record.source = source;
+	record.fillColor = fillColor;
+}
+
+TiledCanvas::Record TiledCanvas::endRecord()
+{
+	Record r = record;
+	recording = false;
+	record = Record();
+	return r;
+}
+
+void TiledCanvas::recordTile(int t)
+{
+	if (!recording || recorded[t] == recordStamp)
+		return;
+	recorded[t] = recordStamp;
+	record.tiles.append(t);
+	record.before.append(tiles[t]);
+}
+
+void TiledCanvas::setTile(int t, QImage tile)
+{
+	if (tile.isNull()) {
+		if (!tiles[t].isNull())
+			allocated.removeOne(t);
+	}
+	else if (tiles[t].isNull())
+		allocated.append(t);
+	tiles[t] = tile;
+}
+
+void TiledCanvas::setBackground(QSharedPointer<const ImageSource> src, QRgb fill)
+{
+	source = src;
+	fillColor = fill;
+}
+
+QImage& TiledCanvas::tileForWrite(int t)
+{
+	recordTile(t);
+	if (tiles[t].isNull()) {
+		QRect r = tileRect(t);
+		if (source) {
+			tiles[t] = source->read(r);
+		}
+		else {
+			tiles[t] = QImage(r.size(), QImage::Format_ARGB32);
+			tiles[t].fill(fillColor);
+		}
+		allocated.append(t);
+	}
+	return tiles[t];
+}
+
+bool TiledCanvas::tileRange(QRect area, int& tx0, int& ty0, int& tx1, int& ty1) const
+{
+	area = area.intersected(QRect(QPoint(0, 0), size));
+	if (area.isEmpty())
+		return false;
+	tx0 = area.left() / tileSize;
+	ty0 = area.top() / tileSize;
+	tx1 = area.right() / tileSize;
+	ty1 = area.bottom() / tileSize;
+	return true;
+}
+
+void TiledCanvas::draw(QPainter& painter, QRect area) const
+{
+	int tx0, ty0, tx1, ty1;
+	if (!tileRange(area, tx0, ty0, tx1, ty1))
+		return;
+	for (int ty = ty0; ty <= ty1; ty++) {
+		for (int tx = tx0; tx <= tx1; tx++) {
+			int t = ty * tilesX + tx;
+			QRect r = tileRect(t), cast = r.intersected(area);
+			if (!tiles[t].isNull())
+				painter.drawImage(cast, tiles[t], cast.translated(-r.topLeft()));
+			else if (source)
+				source->draw(painter, cast);
+			else
+				painter.fillRect(cast, QColor::fromRgba(fillColor));
+		}
+	}
+}
+
+void TiledCanvas::write(const QImage& src, QPoint at)
+{
+	QImage obr = src.format() == QImage::Format_ARGB32 ? src : src.convertToFormat(QImage::Format_ARGB32);
+	QRect area = QRect(at, obr.size());
+	int tx0, ty0, tx1, ty1;
+	if (!tileRange(area, tx0, ty0, tx1, ty1))
+		return;
+	for (int ty = ty0; ty <= ty1; ty++) {
+		for (int tx = tx0; tx <= tx1; tx++) {
+			int t = ty * tilesX + tx;
+			QRect r = tileRect(t), cast = r.intersected(area);
+			QImage& tile = tileForWrite(t);
+			for (int y = cast.top(); y <= cast.bottom(); y++)
+				memcpy(tile.scanLine(y - r.top()) + 4 * (cast.left() - r.left()), obr.constScanLine(y - at.y()) + 4 * (cast.left() - at.x()), 4 * cast.width());
+		}
+	}
+}
+
+QImage TiledCanvas::toImage(QRect area) const
+{
+	area = area.intersected(QRect(QPoint(0, 0), size));
+	QImage out(area.size(), QImage::Format_ARGB32);
+	int tx0, ty0, tx1, ty1;
+	if (!tileRange(area, tx0, ty0, tx1, ty1))
+		return out;
+	for (int ty = ty0; ty <= ty1; ty++) {
+		for (int tx = tx0; tx <= tx1; tx++) {
+			int t = ty * tilesX + tx;
+			QRect r = tileRect(t), cast = r.intersected(area);
+			QImage zdroj = tiles[t].isNull() && source ? source->read(cast) : QImage();
+			for (int y = cast.top(); y <= cast.bottom(); y++) {
+				QRgb* dst = reinterpret_cast<QRgb*>(out.scanLine(y - area.top())) + (cast.left() - area.left());
+				if (!tiles[t].isNull())
+					memcpy(dst, tiles[t].constScanLine(y - r.top()) + 4 * (cast.left() - r.left()), 4 * cast.width());
+				else if (!zdroj.isNull())
+					memcpy(dst, zdroj.constScanLine(y - cast.top()), 4 * cast.width());
+				else
+					std::fill(dst, dst + cast.width(), fillColor);
+			}
+		}
+	}
+	return out;
+}
+
+QByteArray TiledCanvas::encodeStrip(int ty, bool bmp) const
+{
+	QImage pas = toImage(QRect(0, ty * tileSize, size.width(), tileSize));
+	qint64 rowBytes = bmp ? (qint64(pas.width()) * 3 + 3) & ~qint64(3) : qint64(pas.width()) * 3;
+	QByteArray riadky(int(rowBytes * pas.height()), 0);
+	for (int y = 0; y < pas.height(); y++) {
+		//BMP je ulozene zdola nahor, v poradi BGR
+		uchar* p = reinterpret_cast<uchar*>(riadky.data()) + (bmp ? pas.height() - 1 - y : y) * rowBytes;
+		const QRgb* riadok = reinterpret_cast<const QRgb*>(pas.constScanLine(y));
+		for (int x = 0; x < pas.width(); x++) {
+			*p++ = uchar(bmp ? qBlue(riadok[x]) : qRed(riadok[x]));
+			*p++ = uchar(qGreen(riadok[x]));
+			*p++ = uchar(bmp ? qRed(riadok[x]) : qBlue(riadok[x]));
+		}
+	}
+	return riadky;
+}
+
+bool TiledCanvas::save(QString fileName, QByteArray format, int threads) const
+{
+	QByteArray f = format.toLower();
+	if (f != "ppm" && f != "bmp")
+		return toImage().save(fileName, format.constData());
+
+	//binarny PPM (P6) alebo 24-bitove BMP bez kompresie
+	bool bmp = f == "bmp";
+	QByteArray header;
+	if (bmp) {
+		qint64 rowBytes = (qint64(size.width()) * 3 + 3) & ~qint64(3);
+		qint64 fileSize = 54 + rowBytes * size.height();
+		if (fileSize > 0xFFFFFFFFLL)
+			return false;
+		header.fill(0, 54);
+		uchar* h = reinterpret_cast<uchar*>(header.data());
+		h[0] = 'B';
+		h[1] = 'M';
+		qToLittleEndian<quint32>(quint32(fileSize), h + 2);
+		qToLittleEndian<quint32>(54, h + 10);
+		qToLittleEndian<quint32>(40, h + 14);
+		qToLittleEndian<qint32>(size.width(), h + 18);
+		qToLittleEndian<qint32>(size.height(), h + 22);
+		qToLittleEndian<quint16>(1, h + 26);
+		qToLittleEndian<quint16>(24, h + 28);
+		qToLittleEndian<quint32>(quint32(fileSize - 54), h + 34);
+	}
+	else {
+		header = QString("P6\n%1 %2\n255\n").arg(size.width()).arg(size.height()).toLatin1();
+	}
+
+	//zapisuje sa do docasneho suboru, cielovy sa nahradi az po poslednom pase;
+	//nenakreslene dlazdice sa citaju zo zdroja, ktory moze byt namapovany prave z cieloveho suboru
+	QSaveFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly))
+		return false;
+	bool ok = file.write(header) == header.size();
+	//pasy dlazdic sa prevadzaju paralelne po skupinach a zapisuju v poradi, v pamati je naraz len jedna skupina
+	//BMP zacina spodnym pasom
+	threads = qMax(1, threads);
+	QVector<QByteArray> skupina(threads);
+	for (int od = 0; ok && od < tilesY; od += threads) {
+		int n = qMin(threads, tilesY - od);
+		std::atomic<int> dalsi(0);
+		auto prevod = [&]() {
+			for (int k = dalsi++; k < n; k = dalsi++)
+				skupina[k] = encodeStrip(bmp ? tilesY - 1 - (od + k) : od + k, bmp);
+		};
+		QVector<QFuture<void>> vlakna;
+		for (int k = 1; k < n; k++)
+			vlakna.append(QtConcurrent::run(prevod));
+		prevod();
+		for (QFuture<void>& v : vlakna)
+			v.waitForFinished();
+		for (int k = 0; ok && k < n; k++)
+			ok = file.write(skupina[k]) == skupina[k].size();
+	}
+	if (!ok) {
+		file.cancelWriting();
+		return false;
+	}
+	return file.commit();
+}
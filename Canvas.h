@@ -0,0 +1,94 @@
+#pragma once
+#include <QtGui>
+#include "ImageSource.h"
+
+// obrazok rozdeleny na dlazdice tileSize x tileSize (Format_ARGB32)
+// dlazdica sa alokuje az pri prvom zapise, nealokovane dlazdice sa citaju zo zdroja, bez neho maju spolocnu farbu fillColor
+// pamat rastie s plochou, do ktorej sa kreslilo, nie s velkostou obrazka
+class TiledCanvas {
+public:
+	static const int tileSize = 256;
+	// zaznam pre historiu: povodny obsah dlazdic pred prvym zapisom (zdielana kopia, null = nealokovana) a povodne pozadie
+	struct Record {
+		QVector<int> tiles;
+		QVector<QImage> before;
+		QSharedPointer<const ImageSource> source;
+		QRgb fillColor = 0;
+	};
+private:
+	QSize size = QSize(0, 0);
+	QRgb fillColor = 0xffffffff;
+	int tilesX = 0, tilesY = 0;
+	QVector<QImage> tiles;		// null = nealokovana
+	QVector<int> allocated;		// indexy alokovanych dlazdic
+	QSharedPointer<const ImageSource> source;
+	bool recording = false;
+	quint32 recordStamp = 0;
+	QVector<quint32> recorded;	// recordStamp, ak je dlazdica v aktualnom zazname
+	Record record;
+
+	void recordTile(int t);
+	QRect tileRect(int t) const { return QRect((t % tilesX) * tileSize, (t / tilesX) * tileSize, tileSize, tileSize).intersected(QRect(QPoint(0, 0), size)); };
+	QImage& tileForWrite(int t);
+	// pas dlazdic ty ako riadky RGB (PPM) alebo BGR zarovnane na 4 bajty zdola nahor (BMP)
+	QByteArray encodeStrip(int ty, bool bmp) const;
+	// rozsah dlazdic, ktore zasahuju do area (orezanej na obrazok), vrati false, ak ziadne
+	bool tileRange(QRect area, int& tx0, int& ty0, int& tx1, int& ty1) const;
+public:
+	TiledCanvas() {};
+	TiledCanvas(QSize s, QRgb fill) { reset(s, fill); };
+	void reset(QSize s, QRgb fill, QSharedPointer<const ImageSource> src = QSharedPointer<const ImageSource>());
+	// novy zdroj rovnakej velkosti, dlazdice, do ktorych sa uz kreslilo, zostanu
+	bool setSource(QSharedPointer<const ImageSource> src);
+	QSharedPointer<const ImageSource> getSource() const { return source; };
+
+	QSize getSize() const { return size; };
+	int width() const { return size.width(); };
+	int height() const { return size.height(); };
+	bool isEmpty() const { return size.isEmpty(); };
+	QRgb getFillColor() const { return fillColor; };
+	int getAllocatedTiles() const { return allocated.size(); };
+	qint64 getAllocatedBytes() const { return qint64(allocated.size()) * tileSize * tileSize * 4; };
+
+	// uvolni dlazdice aj zdroj, cely obrazok bude mat farbu fill, O(pocet alokovanych dlazdic)
+	void clear(QRgb fill);
+
+	// od beginRecord sa pred prvym zapisom do dlazdice (paint, write, clear) odlozi jej povodny obsah
+	// odlozenie je len zdielana kopia, pixely sa skopiruju az pri zapise, ako by sa kopirovali tak ci tak
+	void beginRecord();
+	bool isRecording() const { return recording; };
+	Record endRecord();
+	// priamy pristup k dlazdiciam pre historiu, null = nealokovana (cita sa zo zdroja alebo ma farbu pozadia)
+	int getTileCount() const { return tiles.size(); };
+	QRect getTileRect(int t) const { return tileRect(t); };
+	QImage tile(int t) const { return tiles[t]; };
+	void setTile(int t, QImage tile);
+	void setBackground(QSharedPointer<const ImageSource> src, QRgb fill);
+
+	// kreslenie cez QPainter do vsetkych dlazdic, ktore zasahuju do area (suradnice celeho obrazka)
+	template <typename F> void paint(QRect area, F kresli) {
+		int tx0, ty0, tx1, ty1;
+		if (!tileRange(area, tx0, ty0, tx1, ty1))
+			return;
+		for (int ty = ty0; ty <= ty1; ty++) {
+			for (int tx = tx0; tx <= tx1; tx++) {
+				int t = ty * tilesX + tx;
+				QPainter painter(&tileForWrite(t));
+				painter.translate(-tileRect(t).topLeft());
+				kresli(painter);
+			}
+		}
+	};
+
+	// vykreslenie casti area do widgetu, nealokovane dlazdice sa kreslia priamo zo zdroja alebo sa vyplnia farbou
+	void draw(QPainter& painter, QRect area) const;
+	// skopiruje src do obrazka na poziciu at
+	void write(const QImage& src, QPoint at = QPoint(0, 0));
+	// cast obrazka ako jeden QImage
+	QImage toImage(QRect area) const;
+	QImage toImage() const { return toImage(QRect(QPoint(0, 0), size)); };
+
+	// PPM a BMP sa zapisuju po pasoch dlazdic prevedenych v threads vlaknach, ostatne formaty cez QImageWriter z celeho obrazka
+	// kopia platna zdiela dlazdice, ulozit ju mozno mimo GUI vlakna, kym sa do originalu dalej kresli
+	bool save(QString fileName, QByteArray format, int threads = QThread::idealThreadCount()) const;
+};
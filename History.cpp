@@ -0,0 +1,293 @@
+#include "History.h"
+
+static qint64 imageBytes(const QImage& img)
+{
+	return qint64(img.bytesPerLine()) * img.height();
+}
+
+void CanvasHistory::setBudget(qint64 memory, qint64 disk)
+{
+	memoryBudget = qMax(memory, qint64(0));
+	diskBudget = qMax(disk, qint64(0));
+	enforceBudget();
+}
+
+void CanvasHistory::clear()
+{
+	steps.clear();
+	position = 0;
+	memoryBytes = 0;
+	diskBytes = 0;
+	spillFile.reset();
+}
+
+void CanvasHistory::push(const TiledCanvas& canvas, const TiledCanvas::Record& record)
+{
+	Step step;
+	step.id = nextId++;
+	for (int i = 0; i < record.tiles.size(); i++) {
+		TileChange c;
+		c.tile = record.tiles[i];
+		c.before = record.before[i];
+		c.after = canvas.tile(c.tile);
+		c.hadBefore = !c.before.isNull();
+		c.hasAfter = !c.after.isNull();
+		if (!c.hadBefore && !c.hasAfter)
+			continue;
+		step.bytes += imageBytes(c.before) + imageBytes(c.after);
+		step.area = step.area.united(canvas.getTileRect(c.tile));
+		step.changes.append(c);
+	}
+	step.sourceBefore = record.source;
+	step.sourceAfter = canvas.getSource();
+	step.fillBefore = record.fillColor;
+	step.fillAfter = canvas.getFillColor();
+	step.background = step.sourceBefore != step.sourceAfter || step.fillBefore != step.fillAfter;
+	if (step.changes.isEmpty() && !step.background)
+		return;
+
+	//novy krok zahodi kroky, ktore sa dali zopakovat
+	while (steps.size() > position) {
+		const Step& s = steps.last();
+		(s.storage == Step::Spilled ? diskBytes : memoryBytes) -= s.bytes;
+		steps.removeLast();
+	}
+	memoryBytes += step.bytes;
+	steps.append(step);
+	position++;
+	enforceBudget();
+}
+
+bool CanvasHistory::undo(TiledCanvas& canvas, QRect* area, bool* background)
+{
+	if (position == 0)
+		return false;
+	position--;
+	apply(canvas, steps[position], false, area, background);
+	return true;
+}
+
+bool CanvasHistory::redo(TiledCanvas& canvas, QRect* area, bool* background)
+{
+	if (position == steps.size())
+		return false;
+	apply(canvas, steps[position], true, area, background);
+	position++;
+	return true;
+}
+
+void CanvasHistory::apply(TiledCanvas& canvas, const Step& step, bool redo, QRect* area, bool* background)
+{
+	for (const TileChange& c : step.changes) {
+		if (!(redo ? c.hasAfter : c.hadBefore)) {
+			canvas.setTile(c.tile, QImage());
+			continue;
+		}
+		if (step.storage == Step::Raw) {
+			canvas.setTile(c.tile, redo ? c.after : c.before);
+			continue;
+		}
+		//XOR sa aplikuje na aktualny obsah dlazdice, ktory je druhou stranou zmeny
+		QByteArray data = qUncompress(packedData(c));
+		QRect r = canvas.getTileRect(c.tile);
+		bool rozdiel = c.hadBefore && c.hasAfter;
+		QImage tile = rozdiel ? canvas.tile(c.tile) : QImage(r.size(), QImage::Format_ARGB32);
+		int w = 4 * r.width();
+		if (tile.size() != r.size() || data.size() != w * r.height()) {
+			qWarning() << "CanvasHistory: poskodena zmena dlazdice" << c.tile;
+			continue;
+		}
+		for (int y = 0; y < r.height(); y++) {
+			uchar* dst = tile.scanLine(y);
+			const uchar* src = reinterpret_cast<const uchar*>(data.constData()) + y * w;
+			if (rozdiel) {
+				for (int x = 0; x < w; x++)
+					dst[x] ^= src[x];
+			}
+			else
+				memcpy(dst, src, w);
+		}
+		canvas.setTile(c.tile, tile);
+	}
+	if (step.background)
+		canvas.setBackground(redo ? step.sourceAfter : step.sourceBefore, redo ? step.fillAfter : step.fillBefore);
+	if (area)
+		*area = step.area;
+	if (background)
+		*background = step.background;
+}
+
+void CanvasHistory::replaceSource(QSharedPointer<const ImageSource> from, QSharedPointer<const ImageSource> to)
+{
+	for (Step& s : steps) {
+		if (s.sourceBefore == from)
+			s.sourceBefore = to;
+		if (s.sourceAfter == from)
+			s.sourceAfter = to;
+	}
+}
+
+bool CanvasHistory::takePackJob(PackJob& job)
+{
+	for (const Step& s : steps) {
+		if (s.storage == Step::Raw) {
+			job.id = s.id;
+			job.changes = s.changes;
+			return true;
+		}
+	}
+	return false;
+}
+
+CanvasHistory::PackResult CanvasHistory::pack(PackJob job)
+{
+	PackResult result;
+	result.id = job.id;
+	for (const TileChange& c : job.changes) {
+		const QImage& a = c.hadBefore ? c.before : c.after;
+		int w = 4 * a.width();
+		QByteArray data(w * a.height(), '\0');
+		for (int y = 0; y < a.height(); y++) {
+			uchar* dst = reinterpret_cast<uchar*>(data.data()) + y * w;
+			const uchar* src = a.constScanLine(y);
+			if (c.hadBefore && c.hasAfter) {
+				const uchar* po = c.after.constScanLine(y);
+				for (int x = 0; x < w; x++)
+					dst[x] = src[x] ^ po[x];
+			}
+			else
+				memcpy(dst, src, w);
+		}
+		result.packed.append(qCompress(data));
+	}
+	return result;
+}
+
+void CanvasHistory::packed(const PackResult& result)
+{
+	//krok mohol byt medzitym zahodeny
+	for (Step& s : steps) {
+		if (s.id != result.id)
+			continue;
+		if (s.storage != Step::Raw || s.changes.size() != result.packed.size())
+			return;
+		qint64 bytes = 0;
+		for (int i = 0; i < s.changes.size(); i++) {
+			TileChange& c = s.changes[i];
+			c.packed = result.packed[i];
+			c.packedSize = c.packed.size();
+			c.before = QImage();
+			c.after = QImage();
+			bytes += c.packedSize;
+		}
+		memoryBytes += bytes - s.bytes;
+		s.bytes = bytes;
+		s.storage = Step::Packed;
+		enforceBudget();
+		return;
+	}
+}
+
+QByteArray CanvasHistory::packedData(const TileChange& change)
+{
+	if (change.offset < 0)
+		return change.packed;
+	QByteArray data;
+	if (spillFile && spillFile->seek(change.offset))
+		data = spillFile->read(change.packedSize);
+	return data;
+}
+
+bool CanvasHistory::spill(Step& step)
+{
+	if (!spillFile) {
+		spillFile.reset(new QTemporaryFile);
+		if (!spillFile->open()) {
+			spillFile.reset();
+			return false;
+		}
+	}
+	qint64 offset = spillFile->size();
+	if (!spillFile->seek(offset))
+		return false;
+	for (const TileChange& c : step.changes) {
+		if (spillFile->write(c.packed) != c.packed.size())
+			return false;
+	}
+	for (TileChange& c : step.changes) {
+		c.offset = offset;
+		offset += c.packedSize;
+		c.packed = QByteArray();
+	}
+	step.storage = Step::Spilled;
+	memoryBytes -= step.bytes;
+	diskBytes += step.bytes;
+	return true;
+}
+
+bool CanvasHistory::compactSpillFile()
+{
+	//zahodene kroky ostavaju v subore, ked je ho vacsina nepouzita, zive data sa prepisu do noveho
+	if (!spillFile || spillFile->size() <= 2 * diskBytes + (qint64(64) << 20))
+		return true;
+	QScopedPointer<QTemporaryFile> novy(new QTemporaryFile);
+	if (!novy->open())
+		return false;
+	QVector<qint64> offsets;
+	for (const Step& s : steps) {
+		if (s.storage != Step::Spilled)
+			continue;
+		for (const TileChange& c : s.changes) {
+			offsets.append(novy->pos());
+			if (novy->write(packedData(c)) != c.packedSize)
+				return false;
+		}
+	}
+	int i = 0;
+	for (Step& s : steps) {
+		if (s.storage != Step::Spilled)
+			continue;
+		for (TileChange& c : s.changes)
+			c.offset = offsets[i++];
+	}
+	spillFile.swap(novy);
+	return true;
+}
+
+void CanvasHistory::dropOldest()
+{
+	//bez najstarsieho kroku sa neda zopakovat ani nic za nim, ak uz bol vrateny
+	if (position == 0) {
+		clear();
+		return;
+	}
+	(steps.first().storage == Step::Spilled ? diskBytes : memoryBytes) -= steps.first().bytes;
+	steps.removeFirst();
+	position--;
+}
+
+void CanvasHistory::enforceBudget()
+{
+	//najstarsie zbalene kroky idu na disk, nezbalene pockaju na pack
+	int i = 0;
+	while (memoryBytes > memoryBudget && i < steps.size()) {
+		if (steps[i].storage != Step::Packed) {
+			i++;
+			continue;
+		}
+		if (!spill(steps[i])) {
+			//bez docasneho suboru sa zahodia najstarsie kroky az po tento
+			for (int k = 0; k <= i && !steps.isEmpty(); k++)
+				dropOldest();
+			i = 0;
+			continue;
+		}
+		i++;
+	}
+	while (diskBytes > diskBudget && !steps.isEmpty())
+		dropOldest();
+	if (steps.isEmpty())
+		clear();
+	else
+		compactSpillFile();
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <QtGui>
+#include "Canvas.h"
+
+// historia uprav platna pre undo/redo, krok si pamata len dlazdice, ktorych sa zmena dotkla
+// zmena dlazdice sa v pozadi zbali (qCompress) ako XOR povodneho a noveho obsahu, nezmenene pixely su nuly
+// zbalene kroky nad pamatovy limit sa odkladaju do docasneho suboru, undo aj redo stoji O(plocha kroku)
+// historia predpoklada, ze platno sa mimo nej nemeni (po inom zapise ju treba zmazat cez clear)
+class CanvasHistory {
+public:
+	// zmena jednej dlazdice, hadBefore / hasAfter = false znamena nealokovanu dlazdicu
+	struct TileChange {
+		int tile = -1;
+		bool hadBefore = false, hasAfter = false;
+		QImage before, after;		// do zbalenia
+		QByteArray packed;			// XOR before a after, ak jedna strana chyba, obsah druhej
+		qint64 offset = -1;			// poloha zbalenych dat v docasnom subore
+		int packedSize = 0;
+	};
+	// kroky sa balia po jednom: pack bezi na inom vlakne, vysledok sa vrati cez packed
+	struct PackJob {
+		quint64 id = 0;
+		QVector<TileChange> changes;
+	};
+	struct PackResult {
+		quint64 id = 0;
+		QVector<QByteArray> packed;
+	};
+
+private:
+	struct Step {
+		quint64 id = 0;
+		enum Storage { Raw, Packed, Spilled } storage = Raw;
+		QVector<TileChange> changes;
+		QRect area;
+		// clear meni aj zdroj a farbu pozadia
+		bool background = false;
+		QSharedPointer<const ImageSource> sourceBefore, sourceAfter;
+		QRgb fillBefore = 0, fillAfter = 0;
+		qint64 bytes = 0;			// pixely (Raw) alebo zbalene data (Packed, Spilled)
+	};
+	QVector<Step> steps;
+	int position = 0;				// steps[0, position) sa daju vratit, steps[position, ...) zopakovat
+	quint64 nextId = 1;
+	qint64 memoryBytes = 0, diskBytes = 0;
+	qint64 memoryBudget = defaultMemoryBudget, diskBudget = defaultDiskBudget;
+	QScopedPointer<QTemporaryFile> spillFile;
+
+	void apply(TiledCanvas& canvas, const Step& step, bool redo, QRect* area, bool* background);
+	void dropOldest();
+	bool spill(Step& step);
+	bool compactSpillFile();
+	void enforceBudget();
+	QByteArray packedData(const TileChange& change);
+
+public:
+	static const qint64 defaultMemoryBudget = qint64(256) << 20;
+	static const qint64 defaultDiskBudget = qint64(4) << 30;
+
+	CanvasHistory() {};
+	CanvasHistory(const CanvasHistory&) = delete;
+	CanvasHistory& operator=(const CanvasHistory&) = delete;
+
+	// pamat nad memoryBudget sa odklada na disk, nad diskBudget sa zahadzuju najstarsie kroky
+	void setBudget(qint64 memory, qint64 disk);
+	void clear();
+
+	// novy krok zo zaznamu platna, zopakovatelne kroky sa zahodia; prazdny zaznam krok nevytvori
+	void push(const TiledCanvas& canvas, const TiledCanvas::Record& record);
+	// area je oblast zmenenych dlazdic, background = zmenil sa zdroj alebo farba pozadia (prekreslit vsetko)
+	bool undo(TiledCanvas& canvas, QRect* area, bool* background);
+	bool redo(TiledCanvas& canvas, QRect* area, bool* background);
+	bool canUndo() const { return position > 0; };
+	bool canRedo() const { return position < steps.size(); };
+	// zdroj nahradeny za iny rovnakeho obsahu (nahlad za dekodovany obrazok)
+	void replaceSource(QSharedPointer<const ImageSource> from, QSharedPointer<const ImageSource> to);
+
+	// najstarsi nezbaleny krok, vrati false, ak ziadny nie je
+	bool takePackJob(PackJob& job);
+	static PackResult pack(PackJob job);
+	void packed(const PackResult& result);
+
+	int getSteps() const { return steps.size(); };
+	qint64 getMemoryBytes() const { return memoryBytes; };
+	qint64 getDiskBytes() const { return diskBytes; };
+};
@@ -0,0 +1,134 @@
+#include "ImageSource.h"
+
+QImage DecodedImageSource::read(QRect area) const
+{
+	QImage cast = img.copy(area);
+	if (cast.format() != QImage::Format_ARGB32)
+		cast = cast.convertToFormat(QImage::Format_ARGB32);
+	return cast;
+}
+
+QRectF PreviewImageSource::previewRect(QRect area) const
+{
+	qreal sx = qreal(preview.width()) / fullSize.width(), sy = qreal(preview.height()) / fullSize.height();
+	return QRectF(area.left() * sx, area.top() * sy, area.width() * sx, area.height() * sy);
+}
+
+QImage PreviewImageSource::read(QRect area) const
+{
+	QImage out(area.size(), QImage::Format_ARGB32);
+	QPainter painter(&out);
+	painter.setRenderHint(QPainter::SmoothPixmapTransform);
+	painter.drawImage(QRectF(QPointF(0, 0), QSizeF(area.size())), preview, previewRect(area));
+	return out;
+}
+
+void PreviewImageSource::draw(QPainter& painter, QRect area) const
+{
+	painter.save();
+	painter.setRenderHint(QPainter::SmoothPixmapTransform);
+	painter.drawImage(QRectF(area), preview, previewRect(area));
+	painter.restore();
+}
+
+MappedImageSource* MappedImageSource::open(QString fileName)
+{
+	MappedImageSource* source = new MappedImageSource(fileName);
+	if (source->file.open(QIODevice::ReadOnly)) {
+		qint64 length = source->file.size();
+		const uchar* data = length >= 2 ? source->file.map(0, length) : nullptr;
+		if (data && (source->mapPnm(data, length) || source->mapBmp(data, length)))
+			return source;
+	}
+	delete source;
+	return nullptr;
+}
+
+// hlavicka "P6 sirka vyska 255" alebo "P5 ...", polozky oddelene bielymi znakmi, # je komentar do konca riadku
+bool MappedImageSource::mapPnm(const uchar* data, qint64 length)
+{
+	if (data[0] != 'P' || (data[1] != '5' && data[1] != '6'))
+		return false;
+	qint64 pos = 2;
+	qint64 polozky[3];
+	for (int k = 0; k < 3; k++) {
+		while (pos < length && (isspace(data[pos]) || data[pos] == '#')) {
+			if (data[pos] == '#')
+				while (pos < length && data[pos] != '\n')
+					pos++;
+			else
+				pos++;
+		}
+		if (pos >= length || !isdigit(data[pos]))
+			return false;
+		polozky[k] = 0;
+		while (pos < length && isdigit(data[pos]) && polozky[k] <= INT_MAX)
+			polozky[k] = polozky[k] * 10 + (data[pos++] - '0');
+	}
+	//za maximalnou hodnotou je prave jeden biely znak
+	if (pos >= length || !isspace(data[pos]) || polozky[0] <= 0 || polozky[1] <= 0 || polozky[0] > INT_MAX || polozky[1] > INT_MAX || polozky[2] != 255)
+		return false;
+	pos++;
+	channels = data[1] == '5' ? 1 : 3;
+	stride = polozky[0] * channels;
+	if (length - pos < stride * polozky[1])
+		return false;
+	imgSize = QSize(int(polozky[0]), int(polozky[1]));
+	pixels = data + pos;
+	return true;
+}
+
+// BITMAPFILEHEADER (14 B) a BITMAPINFOHEADER (aspon 40 B), riadky zarovnane na 4 bajty
+bool MappedImageSource::mapBmp(const uchar* data, qint64 length)
+{
+	if (length < 54 || data[0] != 'B' || data[1] != 'M')
+		return false;
+	quint32 offset = qFromLittleEndian<quint32>(data + 10);
+	quint32 headerSize = qFromLittleEndian<quint32>(data + 14);
+	qint32 w = qFromLittleEndian<qint32>(data + 18);
+	qint32 h = qFromLittleEndian<qint32>(data + 22);
+	quint16 bpp = qFromLittleEndian<quint16>(data + 28);
+	quint32 compression = qFromLittleEndian<quint32>(data + 30);
+	if (headerSize < 40 || compression != 0 || (bpp != 24 && bpp != 32) || w <= 0 || h == 0 || h == INT_MIN)
+		return false;
+	qint64 height = qAbs(qint64(h));
+	qint64 rowBytes = (qint64(w) * bpp / 8 + 3) & ~qint64(3);
+	if (offset > length || length - offset < rowBytes * height)
+		return false;
+	channels = bpp / 8;
+	bgr = true;
+	imgSize = QSize(w, int(height));
+	//kladna vyska: posledny riadok obrazka je v subore prvy
+	if (h > 0) {
+		pixels = data + offset + rowBytes * (height - 1);
+		stride = -rowBytes;
+	}
+	else {
+		pixels = data + offset;
+		stride = rowBytes;
+	}
+	return true;
+}
+
+QImage MappedImageSource::read(QRect area) const
+{
+	area = area.intersected(QRect(QPoint(0, 0), imgSize));
+	QImage out(area.size(), QImage::Format_ARGB32);
+	for (int y = 0; y < area.height(); y++) {
+		const uchar* s = pixels + (area.top() + y) * stride + qint64(area.left()) * channels;
+		QRgb* d = reinterpret_cast<QRgb*>(out.scanLine(y));
+		if (channels == 1) {
+			for (int x = 0; x < area.width(); x++)
+				d[x] = qRgb(s[x], s[x], s[x]);
+		}
+		else if (bgr) {
+			for (int x = 0; x < area.width(); x++, s += channels)
+				d[x] = qRgb(s[2], s[1], s[0]);
+		}
+		else {
+			for (int x = 0; x < area.width(); x++, s += 3)
+				d[x] = qRgb(s[0], s[1], s[2]);
+		}
+	}
+	return out;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <QtGui>
+
+// zdroj obsahu obrazka pre dlazdice TiledCanvas, do ktorych sa este nekreslilo
+// zdroj sa po vytvoreni nemeni, read a draw sa mozu volat z viacerych vlakien naraz
+class ImageSource {
+public:
+	virtual ~ImageSource() {};
+	virtual QSize size() const = 0;
+	// oblast area (suradnice obrazka, vnutri obrazka) v plnom rozliseni ako Format_ARGB32
+	virtual QImage read(QRect area) const = 0;
+	// vykreslenie oblasti area na rovnake miesto v painteri
+	virtual void draw(QPainter& painter, QRect area) const { painter.drawImage(area.topLeft(), read(area)); };
+};
+
+// uz dekodovany obrazok, data sa so zdrojom len zdielaju (bez hlbokej kopie)
+class DecodedImageSource : public ImageSource {
+private:
+	QImage img;
+public:
+	DecodedImageSource(QImage image) : img(std::move(image)) {};
+	QSize size() const override { return img.size(); };
+	QImage read(QRect area) const override;
+	void draw(QPainter& painter, QRect area) const override { painter.drawImage(area, img, area); };
+};
+
+// zmenseny nahlad obrazka velkosti fullSize, zobrazuje sa, kym sa cely obrazok dekoduje v pozadi
+class PreviewImageSource : public ImageSource {
+private:
+	QImage preview;
+	QSize fullSize;
+	QRectF previewRect(QRect area) const;
+public:
+	PreviewImageSource(QImage image, QSize full) : preview(std::move(image)), fullSize(full) {};
+	QSize size() const override { return fullSize; };
+	QImage read(QRect area) const override;
+	void draw(QPainter& painter, QRect area) const override;
+};
+
+// nekomprimovany PPM (P6) a PGM (P5) s 8-bitovymi hodnotami, BMP s 24 alebo 32 bitmi bez kompresie
+// subor sa namapuje do pamate, do ARGB32 sa prevadzaju len citane oblasti
+class MappedImageSource : public ImageSource {
+private:
+	QFile file;
+	const uchar* pixels = nullptr;	// zaciatok riadku y = 0
+	qint64 stride = 0;				// posun medzi riadkami, zaporny pre BMP ulozene zdola nahor
+	QSize imgSize;
+	int channels = 3;				// 1 sivy, 3 RGB / BGR, 4 BGRX
+	bool bgr = false;
+
+	MappedImageSource(QString fileName) : file(fileName) {};
+	bool mapPnm(const uchar* data, qint64 length);
+	bool mapBmp(const uchar* data, qint64 length);
+public:
+	// nullptr, ak subor nie je v podporovanom formate alebo sa neda namapovat
+	static MappedImageSource* open(QString fileName);
+	QSize size() const override { return imgSize; };
+	QImage read(QRect area) const override;
+};
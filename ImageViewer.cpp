@@ -1,9 +1,33 @@
 #include "ImageViewer.h"
+#include <QtConcurrent>
+#include "Batch.h"
 
 ImageViewer::ImageViewer(QWidget* parent)
 	: QMainWindow(parent), ui(new Ui::ImageViewerClass)
 {
 	ui->setupUi(this);
+
+	//priebeh uloh nad sietou v statusBar
+	jobBar = new QProgressBar(this);
+	jobBar->setRange(0, 1000);
+	jobBar->setMaximumWidth(200);
+	jobBar->hide();
+	jobCancel = new QPushButton("Zrusit", this);
+	jobCancel->hide();
+	ui->statusBar->addPermanentWidget(jobBar);
+	ui->statusBar->addPermanentWidget(jobCancel);
+	connect(jobCancel, &QPushButton::clicked, this, &ImageViewer::cancelJobs);
+	connect(&jobWatcher, &QFutureWatcher<bool>::finished, this, &ImageViewer::jobFinished);
+	connect(&jobTimer, &QTimer::timeout, this, &ImageViewer::showJobStatus);
+
+	traceLabel = new QLabel(this);
+	traceLabel->hide();
+	ui->statusBar->addPermanentWidget(traceLabel);
+	connect(&traceTimer, &QTimer::timeout, this, &ImageViewer::showTraceStatus);
+
+	frameTimer.setSingleShot(true);
+	frameTimer.setInterval(16);
+	connect(&frameTimer, &QTimer::timeout, this, &ImageViewer::renderFrame);
 }
 
 //ViewerWidget functions
@@ -38,6 +62,10 @@ bool ImageViewer::ViewerWidgetEventFilter(QObject* obj, QEvent* event)
 	if (!w) {
 		return false;
 	}
+	TRACE_SCOPE("ViewerWidgetEventFilter");
+	if (event->type() == QEvent::MouseButtonPress || event->type() == QEvent::MouseButtonRelease || event->type() == QEvent::MouseMove || event->type() == QEvent::Wheel) {
+		w->markInput();
+	}
 
 	if (event->type() == QEvent::MouseButtonPress) {
 		ViewerWidgetMouseButtonPress(w, event);
@@ -56,6 +84,9 @@ bool ImageViewer::ViewerWidgetEventFilter(QObject* obj, QEvent* event)
 	}
 	else if (event->type() == QEvent::Wheel) {
 		ViewerWidgetWheel(w, event);
+		//koliesko v rezime kamery a s Ctrl priblizuje, obrazok sa neposuva
+		if ((ui->kamera->isChecked() && w == renderTarget) || (static_cast<QWheelEvent*>(event)->modifiers() & Qt::ControlModifier))
+			return true;
 	}
 
 	return QObject::eventFilter(obj, event);
@@ -63,26 +94,47 @@ bool ImageViewer::ViewerWidgetEventFilter(QObject* obj, QEvent* event)
 void ImageViewer::ViewerWidgetMouseButtonPress(ViewerWidget* w, QEvent* event)
 {
 	QMouseEvent* e = static_cast<QMouseEvent*>(event);
+	if (ui->kamera->isChecked() && w == renderTarget) {
+		orbitLast = e->pos();
+		return;
+	}
+	if (e->button() == Qt::LeftButton && w->isSourceLoading()) {
+		ui->statusBar->showMessage("Obrazok sa este nacitava, kreslit sa da az potom.", 3000);
+		return;
+	}
 	if (e->button() == Qt::LeftButton) {
-		w->setFreeDrawBegin(e->pos());
+		w->setFreeDrawBegin(w->mapToImage(e->pos()));
 		w->setFreeDrawActivated(true);
 	}
 }
 void ImageViewer::ViewerWidgetMouseButtonRelease(ViewerWidget* w, QEvent* event)
 {
 	QMouseEvent* e = static_cast<QMouseEvent*>(event);
+	if (ui->kamera->isChecked() && w == renderTarget)
+		return;
 	if (e->button() == Qt::LeftButton && w->getFreeDrawActivated()) {
-		w->freeDraw(e->pos(), QPen(Qt::red));
+		w->freeDraw(w->mapToImage(e->pos()), QPen(Qt::red));
 		w->setFreeDrawActivated(false);
 	}
 }
 void ImageViewer::ViewerWidgetMouseMove(ViewerWidget* w, QEvent* event)
 {
 	QMouseEvent* e = static_cast<QMouseEvent*>(event);
+	if (ui->kamera->isChecked() && w == renderTarget) {
+		//tahanie otaca kameru okolo stredu, 0.4 stupna na pixel
+		if (e->buttons() == Qt::LeftButton) {
+			QPoint d = e->pos() - orbitLast;
+			orbitLast = e->pos();
+			camera.azimuth -= 0.4f * d.x();
+			camera.elevation = qBound(-89.0f, camera.elevation + 0.4f * d.y(), 89.0f);
+			scheduleFrame();
+		}
+		return;
+	}
 	if (e->buttons() == Qt::LeftButton && w->getFreeDrawActivated()) {
-		w->freeDraw(e->pos(), QPen(Qt::red));
+		w->freeDraw(w->mapToImage(e->pos()), QPen(Qt::red));
 		//w->freeDrawDDA(e->pos(), Qt::red);
-		w->setFreeDrawBegin(e->pos());
+		w->setFreeDrawBegin(w->mapToImage(e->pos()));
 	}
 }
 void ImageViewer::ViewerWidgetLeave(ViewerWidget* w, QEvent* event)
@@ -94,6 +146,18 @@ void ImageViewer::ViewerWidgetEnter(ViewerWidget* w, QEvent* event)
 void ImageViewer::ViewerWidgetWheel(ViewerWidget* w, QEvent* event)
 {
 	QWheelEvent* wheelEvent = static_cast<QWheelEvent*>(event);
+	if (ui->kamera->isChecked() && w == renderTarget) {
+		//jeden krok kolieska (120) priblizi o 10 %
+		float kroky = wheelEvent->angleDelta().y() / 120.0f;
+		camera.distance = qBound(1.2f, camera.distance * float(pow(0.9, kroky)), 50.0f);
+		scheduleFrame();
+	}
+	else if (wheelEvent->modifiers() & Qt::ControlModifier) {
+		//Ctrl + koliesko meni priblizenie obrazka po nasobkoch odmocniny z 2
+		int krok = wheelEvent->angleDelta().y() > 0 ? 1 : (wheelEvent->angleDelta().y() < 0 ? -1 : 0);
+		w->setZoomStep(w->getZoomStep() + krok);
+		ui->statusBar->showMessage(QString("Priblizenie %1 %").arg(qRound(w->getZoom() * 100)), 2000);
+	}
 }
 
 //ImageViewer Events
@@ -101,6 +165,12 @@ void ImageViewer::closeEvent(QCloseEvent* event)
 {
 	if (QMessageBox::Yes == QMessageBox::question(this, "Close Confirmation", "Are you sure you want to exit?", QMessageBox::Yes | QMessageBox::No))
 	{
+		//bezaca uloha sa zrusi a pocka sa na jej koniec
+		jobs.clear();
+		jobProgress.cancel();
+		jobWatcher.waitForFinished();
+		for (QFutureWatcher<bool>* s : saves)
+			s->waitForFinished();
 		event->accept();
 	}
 	else {
@@ -121,6 +191,8 @@ void ImageViewer::openNewTabForImg(ViewerWidget* vW)
 
 	vW->setObjectName("ViewerWidget");
 	vW->installEventFilter(this);
+	//pamat historie v MB, starsie kroky sa odkladaju do docasneho suboru
+	vW->setHistoryBudget(settings.value("history_memory_mb", 256).toLongLong() << 20, settings.value("history_disk_mb", 4096).toLongLong() << 20);
 
 	QString name = vW->getName();
 
@@ -136,17 +208,92 @@ bool ImageViewer::openImage(QString filename)
 
 	ViewerWidget* w = getCurrentViewerWidget();
 
-	QImage loadedImg(filename);
-	return w->setImage(loadedImg);
+	//PPM, PGM a BMP bez kompresie sa citaju priamo z namapovaneho suboru, len viditelne oblasti
+	QSharedPointer<const ImageSource> mapped(MappedImageSource::open(filename));
+	if (mapped) {
+		return w->setSource(mapped);
+	}
+
+	QImageReader reader(filename);
+	QSize size = reader.size();
+	if (!size.isValid() || qint64(size.width()) * size.height() <= backgroundDecodePixels) {
+		return w->setImage(reader.read());
+	}
+
+	//zmenseny nahlad len ak ho format vie dekodovat rychlo (napr. JPEG), inak jednofarebna plocha
+	QImage preview;
+	if (reader.supportsOption(QImageIOHandler::ScaledSize)) {
+		reader.setScaledSize(size.scaled(previewSide, previewSide, Qt::KeepAspectRatio));
+		preview = reader.read();
+	}
+	if (preview.isNull()) {
+		preview = QImage(1, 1, QImage::Format_ARGB32);
+		preview.fill(Qt::lightGray);
+	}
+	if (!w->setSource(QSharedPointer<const ImageSource>(new PreviewImageSource(std::move(preview), size)))) {
+		return false;
+	}
+	decodeInBackground(w, filename);
+	return true;
+}
+void ImageViewer::decodeInBackground(ViewerWidget* w, QString filename)
+{
+	ui->statusBar->showMessage(QString("Nacitava sa %1").arg(filename));
+	QPointer<ViewerWidget> target = w;
+	QSharedPointer<const ImageSource> preview = w->getSource();
+	w->setSourceLoading(true);
+	QFutureWatcher<QImage>* watcher = new QFutureWatcher<QImage>(this);
+	connect(watcher, &QFutureWatcher<QImage>::finished, this, [=]() {
+		QImage img = watcher->result();
+		watcher->deleteLater();
+		//karta mohla byt medzitym zatvorena alebo vymazana
+		if (!target)
+			return;
+		target->setSourceLoading(false);
+		if (target->getSource() != preview)
+			return;
+		if (img.isNull() || !target->replaceSource(QSharedPointer<const ImageSource>(new DecodedImageSource(std::move(img))))) {
+			ui->statusBar->showMessage(QString("Obrazok %1 sa nepodarilo nacitat").arg(filename));
+			return;
+		}
+		ui->statusBar->showMessage(QString("Nacitany %1").arg(filename), 5000);
+	});
+	watcher->setFuture(QtConcurrent::run([filename]() {
+		QImageReader reader(filename);
+		return reader.read();
+	}));
 }
 bool ImageViewer::saveImage(QString filename)
 {
 	QFileInfo fi(filename);
 	QString extension = fi.completeSuffix();
 	ViewerWidget* w = getCurrentViewerWidget();
+	if (!w) {
+		return false;
+	}
 
-	QImage* img = w->getImage();
-	return img->save(filename, extension.toStdString().c_str());
+	//kopia zdiela dlazdice s platnom, kreslenie pocas ukladania si zmenene dlazdice skopiruje
+	TiledCanvas snapshot = w->getCanvas();
+	QByteArray format = extension.toLatin1();
+	QFutureWatcher<bool>* watcher = new QFutureWatcher<bool>(this);
+	saves.append(watcher);
+	connect(watcher, &QFutureWatcher<bool>::finished, this, [=]() {
+		saves.removeOne(watcher);
+		watcher->deleteLater();
+		if (watcher->result()) {
+			ui->statusBar->showMessage(QString("File %1 saved.").arg(filename), 5000);
+			return;
+		}
+		ui->statusBar->clearMessage();
+		msgBox.setText(QString("Unable to save image %1.").arg(filename));
+		msgBox.setIcon(QMessageBox::Warning);
+		msgBox.exec();
+	});
+	watcher->setFuture(QtConcurrent::run([snapshot, filename, format]() {
+		return snapshot.save(filename, format);
+	}));
+	ui->statusBar->showMessage(QString("Saving %1...").arg(filename));
+	return true;
 }
 void ImageViewer::clearImage()
 {
@@ -239,11 +386,6 @@ void ImageViewer::on_actionSave_as_triggered()
 		msgBox.setIcon(QMessageBox::Warning);
 		msgBox.exec();
 	}
-	else {
-		msgBox.setText(QString("File %1 saved.").arg(fileName));
-		msgBox.setIcon(QMessageBox::Information);
-		msgBox.exec();
-	}
 }
 void ImageViewer::on_actionClear_triggered()
 {
@@ -255,467 +397,308 @@ void ImageViewer::on_actionClear_triggered()
 	}
 	clearImage();
 }
-
-void ImageViewer::on_generuj_clicked() {
-
-	//pridaj vycistenie octa
-	if (!octa.HisEmpty())
-		octa.clear();
-
-	int i;
-	QList<Vertex>* Vrcholy;
-	Vrcholy = new QList<Vertex>;
-	Vrcholy->reserve(6);
-	for (i = 0; i < 6; i++) {
-		*Vrcholy << Vertex();
+void ImageViewer::on_actionUndo_triggered()
+{
+	if (!isImgOpened()) {
+		return;
 	}
-
-	QList<H_Edge>* Polohrany;
-	Polohrany = new QList<H_Edge>;
-	Polohrany->reserve(24);
-	for (i = 0; i < 24; i++) {
-		*Polohrany << H_Edge();
+	if (!getCurrentViewerWidget()->undo()) {
+		ui->statusBar->showMessage("Nothing to undo.", 2000);
 	}
-
-	QList<Face>* Steny;
-	Steny = new QList<Face>;
-	Steny->reserve(8);
-	for (i = 0; i < 8; i++) {
-		*Steny << Face();
-	}
-
-	(*Vrcholy)[0].set(0, 0.0, 0.0, 1.0);
-	(*Vrcholy)[1].set(1, -1.0, 0.0, 0.0);
-	(*Vrcholy)[2].set(2, 0.0, -1.0, 0.0);
-	(*Vrcholy)[3].set(3, 1.0, 0.0, 0.0);
-	(*Vrcholy)[4].set(4, 0.0, 1.0, 0.0);
-	(*Vrcholy)[5].set(5, 0.0, 0.0, -1.0);
-	
-
-	(*Polohrany)[0].set(&(*Vrcholy)[1], &(*Steny)[0], &(*Polohrany)[2], &(*Polohrany)[1], &(*Polohrany)[12]);
-	(*Polohrany)[1].set(&(*Vrcholy)[2], &(*Steny)[0], &(*Polohrany)[0], &(*Polohrany)[2], &(*Polohrany)[5]);
-	(*Polohrany)[2].set(&(*Vrcholy)[0], &(*Steny)[0], &(*Polohrany)[1], &(*Polohrany)[0], &(*Polohrany)[10]);
-
-	(*Polohrany)[3].set(&(*Vrcholy)[2], &(*Steny)[1], &(*Polohrany)[5], &(*Polohrany)[4], &(*Polohrany)[15]);
-	(*Polohrany)[4].set(&(*Vrcholy)[3], &(*Steny)[1], &(*Polohrany)[3], &(*Polohrany)[5], &(*Polohrany)[8]);
-	(*Polohrany)[5].set(&(*Vrcholy)[0], &(*Steny)[1], &(*Polohrany)[4], &(*Polohrany)[3], &(*Polohrany)[1]);
-
-	(*Polohrany)[6].set(&(*Vrcholy)[3], &(*Steny)[2], &(*Polohrany)[8], &(*Polohrany)[7], &(*Polohrany)[18]);
-	(*Polohrany)[7].set(&(*Vrcholy)[4], &(*Steny)[2], &(*Polohrany)[6], &(*Polohrany)[8], &(*Polohrany)[11]);
-	(*Polohrany)[8].set(&(*Vrcholy)[0], &(*Steny)[2], &(*Polohrany)[7], &(*Polohrany)[6], &(*Polohrany)[4]);
-
-	(*Polohrany)[9].set(&(*Vrcholy)[4], &(*Steny)[3], &(*Polohrany)[11], &(*Polohrany)[10], &(*Polohrany)[21]);
-	(*Polohrany)[10].set(&(*Vrcholy)[1], &(*Steny)[3], &(*Polohrany)[9], &(*Polohrany)[11], &(*Polohrany)[2]);
-	(*Polohrany)[11].set(&(*Vrcholy)[0], &(*Steny)[3], &(*Polohrany)[10], &(*Polohrany)[9], &(*Polohrany)[7]);
-
-	(*Polohrany)[12].set(&(*Vrcholy)[2], &(*Steny)[4], &(*Polohrany)[14], &(*Polohrany)[13], &(*Polohrany)[0]);
-	(*Polohrany)[13].set(&(*Vrcholy)[1], &(*Steny)[4], &(*Polohrany)[12], &(*Polohrany)[14], &(*Polohrany)[23]);
-	(*Polohrany)[14].set(&(*Vrcholy)[5], &(*Steny)[4], &(*Polohrany)[13], &(*Polohrany)[12], &(*Polohrany)[16]);
-
-	(*Polohrany)[15].set(&(*Vrcholy)[3], &(*Steny)[5], &(*Polohrany)[17], &(*Polohrany)[16], &(*Polohrany)[3]);
-	(*Polohrany)[16].set(&(*Vrcholy)[2], &(*Steny)[5], &(*Polohrany)[15], &(*Polohrany)[17], &(*Polohrany)[16]);
-	(*Polohrany)[17].set(&(*Vrcholy)[5], &(*Steny)[5], &(*Polohrany)[16], &(*Polohrany)[15], &(*Polohrany)[19]);
-
-	(*Polohrany)[18].set(&(*Vrcholy)[4], &(*Steny)[6], &(*Polohrany)[20], &(*Polohrany)[19], &(*Polohrany)[6]);
-	(*Polohrany)[19].set(&(*Vrcholy)[3], &(*Steny)[6], &(*Polohrany)[18], &(*Polohrany)[20], &(*Polohrany)[17]);
-	(*Polohrany)[20].set(&(*Vrcholy)[5], &(*Steny)[6], &(*Polohrany)[19], &(*Polohrany)[18], &(*Polohrany)[22]);
-
-	(*Polohrany)[21].set(&(*Vrcholy)[1], &(*Steny)[7], &(*Polohrany)[23], &(*Polohrany)[22], &(*Polohrany)[9]);
-	(*Polohrany)[22].set(&(*Vrcholy)[4], &(*Steny)[7], &(*Polohrany)[21], &(*Polohrany)[23], &(*Polohrany)[20]);
-	(*Polohrany)[23].set(&(*Vrcholy)[5], &(*Steny)[7], &(*Polohrany)[22], &(*Polohrany)[21], &(*Polohrany)[13]);
-	
-	
-
-	(*Steny)[0].setEdge(&(*Polohrany)[0]);
-	(*Steny)[1].setEdge(&(*Polohrany)[3]);
-	(*Steny)[2].setEdge(&(*Polohrany)[6]);
-	(*Steny)[3].setEdge(&(*Polohrany)[9]);
-	(*Steny)[4].setEdge(&(*Polohrany)[12]);
-	(*Steny)[5].setEdge(&(*Polohrany)[15]);
-	(*Steny)[6].setEdge(&(*Polohrany)[18]);
-	(*Steny)[7].setEdge(&(*Polohrany)[21]);
-
-	octa.setVrcholy(Vrcholy);
-	octa.setHrany(Polohrany);
-	octa.setSteny(Steny);
-	msgBox.setText(u8"Octahedron bol vytvoren.");
-	msgBox.setIcon(QMessageBox::Information);
-	msgBox.exec();
-
 }
-
-void ImageViewer::on_rozdel_clicked() {
-	QList<Vertex>* Vrcholy = octa.getVrcholy();
-	QList<H_Edge>* Polohrany = octa.getHrany();
-	QList<Face>* Steny = octa.getSteny();
-	double x0 ,x1, x, y0, y1, y, z0, z1, z, d;
-	int i, j, stenySize= octa.getStenysize(), polohranySize = octa.getHranysize();
-	H_Edge* actualEdge;
-	for (i = 0; i < stenySize; i++) {
-		actualEdge = (*Steny)[i].getEdge();
-		int indexOriginVertex0 = actualEdge->getVOIndex();
-		int indexOriginVertex1 = actualEdge->getHrana_next()->getVOIndex();
-		int indexOriginVertex2 = actualEdge->getHrana_prev()->getVOIndex();
-
-		x0 = (*Vrcholy)[indexOriginVertex0].getX();			//prvy bod
-		x1 = (*Vrcholy)[indexOriginVertex1].getX();
-		x = (x0 + x1) / 2.0;
-		y0 = (*Vrcholy)[indexOriginVertex0].getY();
-		y1 = (*Vrcholy)[indexOriginVertex1].getY();
-		y = (y0 + y1) / 2.0;
-		z0 = (*Vrcholy)[indexOriginVertex0].getZ();
-		z1 = (*Vrcholy)[indexOriginVertex1].getZ();
-		z = (z0 + z1) / 2.0;
-		/*d = sqrt(x * x + y * y + z * z); //projekcia na jednotkovu kruznicu 
-		x = x / d;
-		y = y / d;
-		z = z / d;*/
-
-		Vertex* A;
-		A = new Vertex();
-		int indexA = -1;
-		(*A).setSur(x, y, z);
-		for (j = 0; j < octa.getVrcholysize(); j++) {
-			if ((*Vrcholy)[j].getX() == (*A).getX() && (*Vrcholy)[j].getY() == (*A).getY() && (*Vrcholy)[j].getZ() == (*A).getZ()) {
-				indexA = j;
-				(*A).setIndex(j);
-			}
-		}
-		if (indexA == -1) {
-			(*A).setIndex(octa.getVrcholysize());
-			Vrcholy->append(*A);
-		}
-
-
-		x0 = (*Vrcholy)[indexOriginVertex0].getX();			//druhy bod
-		x1 = (*Vrcholy)[indexOriginVertex2].getX();
-		x = (x0 + x1) / 2.0;
-		y0 = (*Vrcholy)[indexOriginVertex0].getY();
-		y1 = (*Vrcholy)[indexOriginVertex2].getY();
-		y = (y0 + y1) / 2.0;
-		z0 = (*Vrcholy)[indexOriginVertex0].getZ();
-		z1 = (*Vrcholy)[indexOriginVertex2].getZ();
-		z = (z0 + z1) / 2.0;
-		/*d = sqrt(x * x + y * y + z * z); //projekcia na jednotkovu kruznicu 
-		x = x / d;
-		y = y / d;
-		z = z / d;*/
-
-		Vertex* B;
-		B = new Vertex();
-		int indexB = -1;
-		(*B).setSur(x, y, z);
-		for (j = 0; j < octa.getVrcholysize(); j++) {
-			if ((*Vrcholy)[j].getX() == (*B).getX() && (*Vrcholy)[j].getY() == (*B).getY() && (*Vrcholy)[j].getZ() == (*B).getZ()) {
-				indexB = j;
-				(*B).setIndex(j);
-			}
-		}
-		if (indexB == -1) {
-			(*B).setIndex(octa.getVrcholysize());
-			Vrcholy->append(*B);
-		}
-
-
-		x0 = (*Vrcholy)[indexOriginVertex1].getX();			//treti bod
-		x1 = (*Vrcholy)[indexOriginVertex2].getX();
-		x = (x0 + x1) / 2.0;
-		y0 = (*Vrcholy)[indexOriginVertex1].getY();
-		y1 = (*Vrcholy)[indexOriginVertex2].getY();
-		y = (y0 + y1) / 2.0;
-		z0 = (*Vrcholy)[indexOriginVertex1].getZ();
-		z1 = (*Vrcholy)[indexOriginVertex2].getZ();
-		z = (z0 + z1) / 2.0;
-		/*d = sqrt(x * x + y * y + z * z); //projekcia na jednotkovu kruznicu 
-		x = x / d;
-		y = y / d;
-		z = z / d;*/
-
-		Vertex* C;
-		C = new Vertex();
-		int indexC = -1;
-		(*C).setSur(x, y, z);
-		for (j = 0; j < octa.getVrcholysize(); j++) {
-			if ((*Vrcholy)[j].getX() == (*C).getX() && (*Vrcholy)[j].getY() == (*C).getY() && (*Vrcholy)[j].getZ() == (*C).getZ()) {
-				indexC = j;
-				(*C).setIndex(j);
-			}
-		}
-		if (indexC == -1) {
-			(*C).setIndex(octa.getVrcholysize());
-			Vrcholy->append(*C);
-		}
-
-		Face* f0 = new Face();
-		Face* f1 = new Face();
-		Face* f2 = new Face();
-		Face* f3 = new Face();
-
-		H_Edge* e0 = new H_Edge();
-		H_Edge* e1 = new H_Edge();
-		H_Edge* e2 = new H_Edge();
-		H_Edge* e3 = new H_Edge();
-		H_Edge* e4 = new H_Edge();
-		H_Edge* e5 = new H_Edge();
-		H_Edge* e6 = new H_Edge();
-		H_Edge* e7 = new H_Edge();
-		H_Edge* e8 = new H_Edge();
-		H_Edge* e9 = new H_Edge();
-		H_Edge* e10 = new H_Edge();
-		H_Edge* e11 = new H_Edge();
-
-		(*e0).set(&(*Vrcholy)[indexOriginVertex0], f0, e2, e1, NULL);
-		(*Polohrany).append(*e0);
-		(*e1).set(&(*A), f0, e0, e2, e9);
-		(*Polohrany).append(*e1);
-		(*e2).set(&(*B), f0, e1, e0, NULL);
-		(*Polohrany).append(*e2);
-		(*e3).set(&(*A), f1, e5, e4, NULL);
-		(*Polohrany).append(*e3);
-		(*e4).set(&(*Vrcholy)[indexOriginVertex1], f1, e3, e5, NULL);
-		(*Polohrany).append(*e4);
-		(*e5).set(&(*C), f1, e4, e3, e10);
-		(*Polohrany).append(*e5);
-		(*e6).set(&(*B), f2, e8, e7, e11);
-		(*Polohrany).append(*e6);
-		(*e7).set(&(*C), f2, e6, e8, NULL);
-		(*Polohrany).append(*e7);
-		(*e8).set(&(*Vrcholy)[indexOriginVertex2], f2, e7, e6, NULL);
-		(*Polohrany).append(*e8);
-		(*e9).set(&(*B), f3, e11, e10, e1);
-		(*Polohrany).append(*e9);
-		(*e10).set(&(*A), f3, e9, e11, e5);
-		(*Polohrany).append(*e10);
-		(*e11).set(&(*C), f3, e10, e9, e6);
-		(*Polohrany).append(*e11);
-
-		(*f0).setEdge(&(*e0));
-		(*Steny).append(*f0);
-		(*f1).setEdge(&(*e3));
-		(*Steny).append(*f1);
-		(*f2).setEdge(&(*e6));
-		(*Steny).append(*f2);
-		(*f3).setEdge(&(*e9));
-		(*Steny).append(*f3);
-	}
-	//projekcia na jednotkovu kruznicu
-	for (i = 0; i < octa.getVrcholysize(); i++) {
-		x = (*Vrcholy)[i].getX();
-		y = (*Vrcholy)[i].getY();
-		z = (*Vrcholy)[i].getZ();
-		d = sqrt(x * x + y * y + z * z);
-		if ((1.0 - d) != 0) {
-			(*Vrcholy)[i].setX(x / d);
-			(*Vrcholy)[i].setY(y / d);
-			(*Vrcholy)[i].setZ(z / d);
-		}
+void ImageViewer::on_actionRedo_triggered()
+{
+	if (!isImgOpened()) {
+		return;
 	}
-
-	for (i = 0; i < polohranySize; i++) {
-		(*Polohrany).removeFirst();
+	if (!getCurrentViewerWidget()->redo()) {
+		ui->statusBar->showMessage("Nothing to redo.", 2000);
 	}
-	for (i = 0; i < stenySize; i++) {
-		(*Steny).removeFirst();
+}
+void ImageViewer::on_actionTrace_toggled(bool checked)
+{
+	Trace::setEnabled(checked);
+	traceLabel->setVisible(checked);
+	if (checked) {
+		showTraceStatus();
+		traceTimer.start(500);
+	}
+	else {
+		traceTimer.stop();
 	}
-	octa.setVrcholy(Vrcholy);
-	octa.setHrany(Polohrany);
-	octa.setSteny(Steny);
-	octa.setParove();
-	qDebug() << "delenie OK";
 }
+void ImageViewer::on_actionExport_trace_triggered()
+{
+	QString folder = settings.value("folder_trace_save_path", "").toString();
+	QString fileName = QFileDialog::getSaveFileName(this, "Export trace", folder + "/trace.json", "Chrome trace (*.json)");
+	if (fileName.isEmpty()) { return; }
 
-void ImageViewer::on_imp_clicked() {
-
-	//pridat vycistenie octa
-	if (!octa.HisEmpty())
-		octa.clear();
+	QFileInfo fi(fileName);
+	settings.setValue("folder_trace_save_path", fi.absoluteDir().absolutePath());
 
-	//otvorenie suboru
-	QString fileName = QFileDialog::getOpenFileName(this, "Load hedron", "", "Vtk data (*.vtk *.txt);;All files (*)");
-	if (fileName.isEmpty()) { return; }
-	QFile file;
-	file.setFileName(fileName);
-	if (!file.open(QIODevice::ReadOnly)) {
-		msgBox.setText("Unable to open file.");
-		msgBox.setIcon(QMessageBox::Warning);
-		msgBox.exec();
-	}
-	//kontrola uvodnych riadkov
-	QString line;
-	line = file.readLine();
-	if (line != "# vtk DataFile Version 3.0\r\n") {
-		msgBox.setText(u8"Hlavika sboru nie je sprvna.");
+	QString error;
+	if (!Trace::exportChrome(fileName, &error)) {
+		msgBox.setText(error);
 		msgBox.setIcon(QMessageBox::Warning);
 		msgBox.exec();
 		return;
 	}
-	line = file.readLine();
-	if (line != "vtk output\r\n") {
-		msgBox.setText(u8"Hlavika sboru nie je sprvna.");
-		msgBox.setIcon(QMessageBox::Warning);
-		msgBox.exec();
+	ui->statusBar->showMessage(QString("Trace %1 saved.").arg(fileName), 5000);
+}
+void ImageViewer::showTraceStatus()
+{
+	//pamat sa vzorkuje spolu so zobrazenim, v zazname su to krivky pocitadiel
+	if (isImgOpened()) {
+		Trace::counter("canvas bytes", getCurrentViewerWidget()->getCanvasBytes());
+		Trace::counter("history bytes", getCurrentViewerWidget()->getHistoryBytes());
+	}
+	Trace::counter("peak RSS", peakResidentBytes());
+
+	QHash<QString, Trace::Stat> s = Trace::summary(Trace::now() - 1000000000LL);
+	auto ms = [&](QString name) {
+		const Trace::Stat& t = s[name];
+		return t.count == 0 ? QString("-") : QString("%1/%2 ms").arg(t.total / 1e6 / t.count, 0, 'f', 2).arg(t.max / 1e6, 0, 'f', 2);
+	};
+	traceLabel->setText(QString("input->paint %1 | paint %2 | filter %3 | %4 paint/s | V %5 F %6")
+		.arg(ms("input to paint")).arg(ms("paint")).arg(ms("ViewerWidgetEventFilter")).arg(s["paint"].count)
+		.arg(octa.getVrcholysize()).arg(octa.getStenysize()));
+}
+
+//Mesh jobs
+void ImageViewer::enqueueJob(QString name, MeshJobFunction run)
+{
+	jobs.enqueue(MeshJob{ name, run });
+	if (jobRunning)
+		showJobStatus();
+	else
+		startNextJob();
+}
+
+void ImageViewer::startNextJob()
+{
+	jobRunning = !jobs.isEmpty();
+	if (jobs.isEmpty()) {
+		jobTimer.stop();
+		jobBar->hide();
+		jobCancel->hide();
 		return;
 	}
-	line = file.readLine();
-	if (line != "ASCII\r\n") {
-		msgBox.setText(u8"Hlavika sboru nie je sprvna.");
-		msgBox.setIcon(QMessageBox::Warning);
-		msgBox.exec();
+	MeshJob job = jobs.dequeue();
+	jobName = job.name;
+	jobProgress.reset();
+	jobResult = Hedron();
+	jobMessage.clear();
+
+	//uloha pracuje s kopiou octa (QVector zdiela data, kym sa nezapisuje)
+	Hedron mesh = octa;
+	jobWatcher.setFuture(QtConcurrent::run([this, job, mesh]() {
+		Trace::Scope scope(Trace::isEnabled() ? Trace::name(job.name) : nullptr);
+		return job.run(mesh, jobResult, &jobProgress, &jobMessage);
+	}));
+
+	jobBar->setValue(0);
+	jobBar->show();
+	jobCancel->show();
+	showJobStatus();
+	jobTimer.start(100);
+}
+
+void ImageViewer::showJobStatus()
+{
+	jobBar->setValue(jobProgress.getPromile());
+	QString text = jobName + "...";
+	if (!jobs.isEmpty())
+		text += QString(" (v poradi %1)").arg(jobs.size());
+	ui->statusBar->showMessage(text);
+}
+
+void ImageViewer::jobFinished()
+{
+	bool ok = jobWatcher.result();
+	if (ok && !jobResult.HisEmpty()) {
+		octa = jobResult;
+		Trace::counter("mesh V", octa.getVrcholysize());
+		Trace::counter("mesh H", octa.getHranysize());
+		Trace::counter("mesh F", octa.getStenysize());
+		if (renderTarget)
+			scheduleFrame();
+	}
+	jobResult = Hedron();
+
+	if (jobProgress.isCancelled()) {
+		ui->statusBar->showMessage(jobName + ": " + jobCancelledText);
+		startNextJob();
 		return;
 	}
-	line = file.readLine();
-	if (line != "DATASET POLYDATA\r\n") {
-		msgBox.setText(u8"Hlavika sboru nie je sprvna.");
+	if (!ok) {
+		//nasledujuce ulohy by pracovali s inou sietou, nez sa cakalo
+		jobs.clear();
+		startNextJob();
+		ui->statusBar->showMessage(jobName + ": " + jobMessage);
+		msgBox.setText(jobMessage);
 		msgBox.setIcon(QMessageBox::Warning);
 		msgBox.exec();
 		return;
 	}
+	ui->statusBar->showMessage(jobMessage);
+	startNextJob();
+}
+
+void ImageViewer::cancelJobs()
+{
+	jobs.clear();
+	jobProgress.cancel();
+}
 
-	//zapis vrcholov
-	int i,j,k,g=0; 
-	line = file.readLine();
-	if (line.split(" ").at(0) != "POINTS")
+void ImageViewer::on_generuj_clicked() {
+
+	//uroven 0 = samotny oktaeder, vyssie urovne sa generuju priamo bez opakovaneho delenia
+	int level = ui->uroven->value();
+	enqueueJob("Generovanie", [level](const Hedron&, Hedron& result, JobProgress* progress, QString* message) {
+		result = geodesicSphere(level, message, progress);
+		if (result.HisEmpty())
+			return false;
+		*message = u8"Octahedron bol vytvoren.";
+		return true;
+	});
+}
+
+void ImageViewer::on_rozdel_clicked() {
+	//siet sa kontroluje az pri spusteni, moze ju este vytvarat predosla uloha
+	enqueueJob("Delenie", [](const Hedron& mesh, Hedron& result, JobProgress* progress, QString* message) {
+		if (mesh.HisEmpty()) {
+			*message = u8"tvar je przdny.";
+			return false;
+		}
+		result = subdivide(mesh, message, progress);
+		if (result.HisEmpty())
+			return false;
+		*message = "delenie OK";
+		return true;
+	});
+}
+
+void ImageViewer::on_vykresli_clicked() {
+	if (octa.HisEmpty()) {
+		msgBox.setText(u8"tvar je przdny.");
+		msgBox.setIcon(QMessageBox::Warning);
+		msgBox.exec();
 		return;
-	int vrcholySize=line.split(" ").at(1).toInt();
-	QList<Vertex>* Vrcholy;
-	Vrcholy = new QList<Vertex>;
-	Vrcholy->reserve(vrcholySize);
-	for (i = 0; i < vrcholySize; i++) {
-		*Vrcholy << Vertex();
 	}
-	for (i = 0; i < vrcholySize; i++) {
-		line = file.readLine();
-		(*Vrcholy)[i].set(i, line.split(" ").at(0).toFloat(), line.split(" ").at(1).toFloat(), line.split(" ").at(2).toFloat());
+	//bez otvoreneho obrazka sa vytvori novy tab
+	if (!isImgOpened()) {
+		openNewTabForImg(new ViewerWidget("Hedron", QSize(800, 600)));
+		ui->tabWidget->setCurrentIndex(ui->tabWidget->count() - 1);
 	}
+	renderTarget = getCurrentViewerWidget();
+	frameDirty = true;
+	renderFrame();
+}
+
+void ImageViewer::on_gouraud_toggled(bool checked)
+{
+	Q_UNUSED(checked);
+	if (renderTarget)
+		scheduleFrame();
+}
+
+void ImageViewer::scheduleFrame()
+{
+	frameDirty = true;
+	if (!frameTimer.isActive())
+		frameTimer.start();
+}
 
-	//zapis hran a stien
-	line = file.readLine();
-	if (line.split(" ").at(0) != "LINES")
+void ImageViewer::renderFrame()
+{
+	//snimku mohlo medzitym vykreslit tlacidlo, casovac ju nekresli znovu
+	if (!frameDirty)
 		return;
-	int polohranySize = line.split(" ").at(1).toInt();
-	QList<H_Edge>* Polohrany;
-	Polohrany = new QList<H_Edge>;
-	Polohrany->reserve(polohranySize*2);
-	for (i = 0; i < polohranySize * 2 ; i++) {
-		*Polohrany << H_Edge();
-	}
-	for (i = 0; i < polohranySize * 2; i += 2) {
-		line = file.readLine();
-		int prvy = line.split(" ").at(1).toInt();
-		int druhy = line.split(" ").at(2).toInt();
-		(*Polohrany)[i].setVert(&(*Vrcholy)[prvy], &(*Vrcholy)[druhy]);
-		(*Polohrany)[i + 1].setVert(&(*Vrcholy)[druhy], &(*Vrcholy)[prvy]);
-		(*Polohrany)[i + 1].setPair(&(*Polohrany)[i]);
-		(*Polohrany)[i].setPair(&(*Polohrany)[i + 1]);
-		}
-	line = file.readLine();
-	if (line.split(" ").at(0) != "POLYGONS")
+	TRACE_SCOPE("renderFrame");
+	frameDirty = false;
+	ViewerWidget* w = renderTarget;
+	if (!w || w->isEmpty() || octa.HisEmpty())
 		return;
-	int stenySize=line.split(" ").at(1).toInt();
-	QList<int> VrcholyStien;
-	QList<Face>* Steny;
-	Steny = new QList<Face>;
-	Steny->reserve(stenySize);
-	for (i = 0; i < stenySize; i++) {
-		*Steny << Face();
-	}
-	for (i = 0; i < stenySize; i++) {
-		int a, b, c;
-		line = file.readLine();
-		a = line.split(" ").at(1).toInt();
-		b = line.split(" ").at(2).toInt();
-		c = line.split(" ").at(3).toInt();
-		VrcholyStien.append(a);
-		VrcholyStien.append(b);
-		VrcholyStien.append(c);
-	int n = -1, p = -1;
-		for (j = 0; j < polohranySize * 2; j++) {
-			if (((*Polohrany)[j].getVOIndex() == a && (*Polohrany)[j].getVEIndex() == b)) {
-				g++;
-				(*Polohrany)[j].setFace(&(*Steny)[i]);
-				for (k = 0; k < polohranySize * 2; k++) {
-					if ((*Polohrany)[k].getVOIndex() == c && (*Polohrany)[k].getVEIndex() == a) {
-						(*Polohrany)[j].setEdgePrev(&(*Polohrany)[k]);
-						(*Polohrany)[k].setEdgeNext(&(*Polohrany)[j]);
-						(*Polohrany)[k].setFace(&(*Steny)[i]);
-						(*Steny)[i].setEdge(&(*Polohrany)[j]);
-						n = k;
-						if (p >= 0) {
-							(*Polohrany)[n].setEdgePrev(&(*Polohrany)[p]);
-							(*Polohrany)[p].setEdgeNext(&(*Polohrany)[n]);
-						}
-					}
-					else if ((*Polohrany)[k].getVOIndex() == b && (*Polohrany)[k].getVEIndex() == c) {
-						(*Polohrany)[j].setEdgeNext(&(*Polohrany)[k]);
-						(*Polohrany)[k].setEdgePrev(&(*Polohrany)[j]);
-						(*Polohrany)[k].setFace(&(*Steny)[i]);
-						p = k;
-						if (n >= 0) {
-							(*Polohrany)[n].setEdgePrev(&(*Polohrany)[p]);
-							(*Polohrany)[p].setEdgeNext(&(*Polohrany)[n]);
-						}
-					}
-				}
-			}
-		}
-	}
-	int a, b, c;
-
-	
-	/*//kontrolne vypisy
-	for (i = 0; i < polohranySize*2; i++)
-		qDebug() <<  (*Polohrany)[i].getVOIndex() << (*Polohrany)[i].getHrana_next()->getVOIndex() << (*Polohrany)[i].getHrana_prev()->getVOIndex();
+	QElapsedTimer timer;
+	timer.start();
+	//snimka sa kresli do jedneho obrazka (rasterizer zapisuje priamo do jeho riadkov) a skopiruje sa do dlazdic platna
+	QSize size = w->getCanvas().getSize();
+	if (frame.size() != size)
+		frame = QImage(size, QImage::Format_ARGB32);
+	rasterizer.setShading(ui->gouraud->isChecked() ? Rasterizer::Gouraud : Rasterizer::Flat);
+	rasterizer.render(octa, camera, frame);
+	w->write(frame);
+	ui->statusBar->showMessage(QString("%1 stien, %2 ms").arg(octa.getStenysize()).arg(timer.elapsed()));
+}
 
-	for (i = 0; i < stenySize; i++)
-		qDebug() << (*Steny)[i].getEdge();*/
+void ImageViewer::on_imp_clicked() {
 
-	file.close();
-	//zapis do octa
-	octa.setVrcholy(Vrcholy);
-	octa.setHrany(Polohrany);
-	octa.setSteny(Steny); 
+	//otvorenie suboru
+	QString folder = settings.value("folder_mesh_load_path", "").toString();
+	QString fileName = QFileDialog::getOpenFileName(this, "Load hedron", folder, "Vtk data (*.vtk *.txt);;Hedron (*.hed);;All files (*)");
+	if (fileName.isEmpty()) { return; }
 
-	msgBox.setText(u8"Import bol spen.");
-	msgBox.setIcon(QMessageBox::Information);
-	msgBox.exec();
+	QFileInfo fi(fileName);
+	settings.setValue("folder_mesh_load_path", fi.absoluteDir().absolutePath());
+
+	//zdvojene vrcholy na svoch (siete z inych programov) sa zvaria, ak ma siet okrajove hrany
+	double tolerance = settings.value("weld_tolerance", 1e-6).toDouble();
+	enqueueJob("Import", [fileName, tolerance](const Hedron&, Hedron& result, JobProgress* progress, QString* message) {
+		result = importMesh(fileName, message, progress);
+		if (result.HisEmpty())
+			return false;
+		WeldResult zvarene;
+		if (result.getBoundaryCount() > 0) {
+			Hedron welded = weldMesh(result, tolerance, message, progress, &zvarene);
+			if (welded.HisEmpty())
+				return false;
+			result = welded;
+		}
+		*message = u8"Import bol spen.";
+		if (zvarene.removedVertices > 0)
+			*message += QString(" (zvarenych vrcholov: %1)").arg(zvarene.removedVertices);
+		if (result.getBoundaryCount() > 0 || result.getNonManifoldCount() > 0)
+			*message += QString(" Hranicne polohrany: %1, nemanifoldne polohrany: %2.").arg(result.getBoundaryCount()).arg(result.getNonManifoldCount());
+		return true;
+	});
 }
 
 void ImageViewer::on_exp_clicked() {
-	int i;
-	//pridat podmienku, ze ak nie je octa empty
-	if (octa.HisEmpty()) {
+	//pridat podmienku, ze ak nie je octa empty (alebo ho este nevytvara uloha)
+	if (octa.HisEmpty() && !jobRunning) {
 		msgBox.setText(u8"tvar je przdny.");
 		msgBox.setIcon(QMessageBox::Warning);
 		msgBox.exec();
 		return;
 	}
 
-	QFile file("out2.vtk");
-	if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
-		return;
+	QString folder = settings.value("folder_mesh_save_path", "").toString();
+	QString vtkAscii = "Vtk ASCII (*.vtk)", vtkBinary = "Vtk binary (*.vtk)", native = "Hedron (*.hed)";
+	QString selectedFilter;
+	QString fileName = QFileDialog::getSaveFileName(this, "Save hedron", folder + "/out2.vtk", vtkAscii + ";;" + vtkBinary + ";;" + native, &selectedFilter);
+	if (fileName.isEmpty()) { return; }
 
-	QTextStream out(&file);
-	out << "# vtk DataFile Version 3.0\n";
-	out << "vtk output\n";
-	out << "ASCII\n";
-	out << "DATASET POLYDATA\n";
-	out << "POINTS " << octa.getVrcholysize() << " float\n";
-	for (i = 0; i < octa.getVrcholysize(); i++) {
-		out << octa.printSur(i) <<"\n";
-	}
-	out << "LINES " << octa.getHranysize() / 2 << " " << octa.getHranysize() / 2 * 3 << "\n";
-	for (i = 0; i < octa.getHranysize(); i++) {
-		if(octa.getHranaOIndex(i)<=octa.getPairHranaOIndex(i))
-			out << "2 " <<octa.printHrana(i) << "\n";
-	}
-	out << "POLYGONS " << octa.getStenysize() << " " << octa.getStenysize() * 4 << "\n";
-	for (i = 0; i < octa.getStenysize(); i++) {
-		out << "3 " << octa.printStena(i) << "\n";
-	}
-	file.close();
-	QString msgText=u8"tvar bol uloen do sboru ";
-	msgText.append(file.fileName());
-	msgBox.setText(msgText);
-	msgBox.setIcon(QMessageBox::Information);
-	msgBox.exec();
-}
\ No newline at end of file
+	QFileInfo fi(fileName);
+	settings.setValue("folder_mesh_save_path", fi.absoluteDir().absolutePath());
+
+	bool toNative = selectedFilter == native || fi.suffix().toLower() == "hed";
+	bool binary = selectedFilter == vtkBinary;
+	enqueueJob("Export", [fileName, toNative, binary](const Hedron& mesh, Hedron&, JobProgress* progress, QString* message) {
+		Hedron hedron = mesh;
+		qint64 bytes = 0;
+		QElapsedTimer timer;
+		timer.start();
+		bool ok;
+		if (toNative)
+			ok = exportNative(hedron, fileName, message, &bytes, progress);
+		else
+			ok = exportVtk(hedron, fileName, binary, message, &bytes, progress);
+		if (!ok)
+			return false;
+		QString msgText = u8"tvar bol uloen do sboru ";
+		msgText.append(fileName);
+		msgText.append(QString(" (%1 B, %2 ms)").arg(bytes).arg(timer.elapsed()));
+		*message = msgText;
+		return true;
+	});
+}
@@ -6,6 +6,13 @@
 #include "ViewerWidget.h"
 #include "NewImageDialog.h"
 #include "Objekt.h"
+#include "MeshIO.h"
+#include "Subdivision.h"
+#include "Weld.h"
+#include "Job.h"
+#include "Rasterizer.h"
+#include "Trace.h"
+#include <functional>
 
 class ImageViewer : public QMainWindow
 {
@@ -43,7 +50,13 @@ private:
 	//Image functions
 	void openNewTabForImg(ViewerWidget* vW);
 	bool openImage(QString filename);
+	//velke obrazky v komprimovanych formatoch sa dekoduju v pozadi, kym sa zobrazuje nahlad
+	static const qint64 backgroundDecodePixels = 4096 * 4096;
+	static const int previewSide = 2048;
+	void decodeInBackground(ViewerWidget* w, QString filename);
+	//ukladanie bezi mimo GUI vlakna nad kopiou platna, pri zatvarani okna sa na neho pocka
 	bool saveImage(QString filename);
+	QList<QFutureWatcher<bool>*> saves;
 	void clearImage();
 
 	//Inline functions
@@ -51,6 +64,46 @@ private:
 
 	Hedron octa;
 
+	//ulohy nad sietou bezia postupne mimo GUI vlakna, kazda dostane octa po dokonceni predoslej
+	//vysledok nahradi octa az po dokonceni, export vrati prazdny result a octa nemeni
+	//message = chyba pri neuspechu, inak text do statusBar
+	typedef std::function<bool(const Hedron& mesh, Hedron& result, JobProgress* progress, QString* message)> MeshJobFunction;
+	struct MeshJob {
+		QString name;
+		MeshJobFunction run;
+	};
+	QQueue<MeshJob> jobs;
+	QString jobName;
+	bool jobRunning = false;	// az do jobFinished, aj ked uz future skoncil
+	QFutureWatcher<bool> jobWatcher;
+	JobProgress jobProgress;
+	Hedron jobResult;
+	QString jobMessage;
+	QTimer jobTimer;
+	QProgressBar* jobBar;
+	QPushButton* jobCancel;
+
+	Rasterizer rasterizer;
+	Camera camera;
+	//snimky sa kreslia do renderTarget; udalosti mysi len oznacia snimku ako neplatnu a frameTimer
+	//ju vykresli najviac raz za 16 ms, pri nehybnej kamere ostava posledna snimka v obrazku
+	QPointer<ViewerWidget> renderTarget;
+	QImage frame;
+	QTimer frameTimer;
+	bool frameDirty = false;
+	QPoint orbitLast;
+	void scheduleFrame();
+	void renderFrame();
+
+	void enqueueJob(QString name, MeshJobFunction run);
+	void startNextJob();
+	void showJobStatus();
+
+	//zaznam Trace: suhrn za poslednu sekundu v statusBar, kym je zapnuty
+	QLabel* traceLabel;
+	QTimer traceTimer;
+	void showTraceStatus();
+
 private slots:
 	//Tabs slots
 	void on_tabWidget_tabCloseRequested(int tabId);
@@ -62,10 +115,20 @@ private slots:
 	void on_actionOpen_triggered();
 	void on_actionSave_as_triggered();
 	void on_actionClear_triggered();
+	void on_actionUndo_triggered();
+	void on_actionRedo_triggered();
+	void on_actionTrace_toggled(bool checked);
+	void on_actionExport_trace_triggered();
 
 	// octahedron slots
 	void on_generuj_clicked();
 	void on_rozdel_clicked();
 	void on_imp_clicked();
 	void on_exp_clicked();
+	void on_vykresli_clicked();
+	void on_gouraud_toggled(bool checked);
+
+	// mesh job slots
+	void jobFinished();
+	void cancelJobs();
 };
@@ -0,0 +1,31 @@
+#pragma once
+#include <QtCore>
+#include <atomic>
+
+// priebeh a zrusenie ulohy bezacej mimo GUI vlakna
+// worker zapisuje priebeh a kontroluje zrusenie, GUI vlakno priebeh cita a ulohu moze zrusit
+class JobProgress {
+	std::atomic<int> promile{ 0 };
+	std::atomic<bool> cancelled{ false };
+	int stageFrom = 0, stageTo = 1000;
+public:
+	void reset() { promile = 0; cancelled = false; stageFrom = 0; stageTo = 1000; };
+
+	// dalsie setProgress sa premietnu do casti <from, to> promile celej ulohy
+	void setStage(int from, int to) { stageFrom = from; stageTo = to; promile = from; };
+	void setProgress(qint64 done, qint64 total) {
+		if (total > 0)
+			promile = stageFrom + int((stageTo - stageFrom) * qBound(qint64(0), done, total) / total);
+	};
+	int getPromile() const { return promile; };
+
+	void cancel() { cancelled = true; };
+	bool isCancelled() const { return cancelled; };
+};
+
+// funkcie beru JobProgress* = nullptr, ked nebezia ako uloha
+inline bool jobCancelled(const JobProgress* progress) { return progress != nullptr && progress->isCancelled(); }
+inline void jobStage(JobProgress* progress, int from, int to) { if (progress) progress->setStage(from, to); }
+inline void jobProgress(JobProgress* progress, qint64 done, qint64 total) { if (progress) progress->setProgress(done, total); }
+
+static const char jobCancelledText[] = "Uloha bola zrusena.";
@@ -0,0 +1,610 @@
+#include "MeshIO.h"
+#include "Trace.h"
+#include <charconv>
+#include <climits>
+
+static Hedron failed(QString* error, QString text)
+{
+	if (error)
+		*error = text;
+	return Hedron();
+}
+
+// citanie VTK priamo z pamate, riadky mozu koncit \n aj \r\n
+class VtkScanner {
+	const char* p;
+	const char* end;
+
+	static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; };
+	void skipSpace() { while (p < end && isSpace(*p)) p++; };
+public:
+	struct Token {
+		const char* begin;
+		int length;
+		bool equals(const char* s) const { int n = int(strlen(s)); return n == length && memcmp(begin, s, n) == 0; };
+		bool startsWith(const char* s) const { int n = int(strlen(s)); return n <= length && memcmp(begin, s, n) == 0; };
+	};
+
+	VtkScanner(const char* begin, const char* e) { p = begin; end = e; };
+	const char* position() const { return p; };
+	qint64 remaining() const { return end - p; };
+	bool atEnd() { skipSpace(); return p >= end; };
+
+	Token line() {
+		const char* b = p;
+		while (p < end && *p != '\n') p++;
+		const char* e = p;
+		if (p < end) p++;
+		while (e > b && isSpace(e[-1])) e--;
+		return Token{ b, int(e - b) };
+	};
+	Token word() {
+		skipSpace();
+		const char* b = p;
+		while (p < end && !isSpace(*p)) p++;
+		return Token{ b, int(p - b) };
+	};
+	bool readInt(int& v) {
+		skipSpace();
+		std::from_chars_result r = std::from_chars(p, end, v);
+		p = r.ptr;
+		return r.ec == std::errc();
+	};
+	// binarny blok zacina hned za koncom riadku s hlavickou sekcie
+	const char* bytes(qint64 n) {
+		if (n < 0 || end - p < n)
+			return nullptr;
+		const char* b = p;
+		p += n;
+		return b;
+	};
+	bool readDouble(double& v) {
+		skipSpace();
+		std::from_chars_result r = std::from_chars(p, end, v);
+		p = r.ptr;
+		return r.ec == std::errc();
+	};
+};
+
+// VTK binary je big-endian, nativny format little-endian
+static qint32 readBE32(const char* p) { return qint32(qFromBigEndian<quint32>(p)); }
+static float readBEFloat(const char* p) { quint32 u = qFromBigEndian<quint32>(p); float f; memcpy(&f, &u, 4); return f; }
+static double readBEDouble(const char* p) { quint64 u = qFromBigEndian<quint64>(p); double d; memcpy(&d, &u, 8); return d; }
+
+template <typename T> static void readLE(const char* src, T* dst, int n)
+{
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+	memcpy(dst, src, size_t(n) * sizeof(T));
+#else
+	for (int i = 0; i < n; i++) {
+		char* d = reinterpret_cast<char*>(dst + i);
+		for (int k = 0; k < int(sizeof(T)); k++)
+			d[k] = src[i * sizeof(T) + sizeof(T) - 1 - k];
+	}
+#endif
+}
+template <typename T> static void writeLE(QByteArray& out, const T* src, int n)
+{
+	int offset = out.size();
+	out.resize(offset + n * int(sizeof(T)));
+	char* dst = out.data() + offset;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+	memcpy(dst, src, size_t(n) * sizeof(T));
+#else
+	for (int i = 0; i < n; i++) {
+		const char* d = reinterpret_cast<const char*>(src + i);
+		for (int k = 0; k < int(sizeof(T)); k++)
+			dst[i * sizeof(T) + k] = d[sizeof(T) - 1 - k];
+	}
+#endif
+}
+
+Hedron buildHedron(const QVector<double>& points, const QVector<int>& faceStart, const QVector<int>& faceIndices, QString* error, JobProgress* progress)
+{
+	TRACE_SCOPE("buildHedron");
+	int i, j;
+	int vrcholySize = points.size() / 3;
+	int stenySize = faceStart.size() - 1;
+	int polohranySize = faceIndices.size();
+	if (vrcholySize == 0 || stenySize <= 0)
+		return failed(error, "Subor neobsahuje ziadne vrcholy alebo steny.");
+
+	Hedron hedron;
+	hedron.resize(vrcholySize, polohranySize, stenySize);
+	for (i = 0; i < vrcholySize; i++) {
+		hedron.setSur(i, points[3 * i], points[3 * i + 1], points[3 * i + 2]);
+		hedron.arrayVertexEdge()[i] = -1;
+	}
+
+	//polohrany steny su ulozene za sebou v poradi jej vrcholov
+	for (i = 0; i < stenySize; i++) {
+		int zaciatok = faceStart[i], n = faceStart[i + 1] - faceStart[i];
+		if (n < 3)
+			return failed(error, QString("Stena %1 ma menej ako 3 vrcholy.").arg(i));
+		for (j = 0; j < n; j++) {
+			int a = faceIndices[zaciatok + j];
+			if (a < 0 || a >= vrcholySize)
+				return failed(error, QString("Stena %1 odkazuje na neexistujuci vrchol.").arg(i));
+			hedron.setEdge(zaciatok + j, a, i, zaciatok + (j + n - 1) % n, zaciatok + (j + 1) % n);
+			hedron.arrayVertexEdge()[a] = zaciatok + j;
+		}
+		hedron.setFaceEdge(i, zaciatok);
+	}
+	if (jobCancelled(progress))
+		return failed(error, jobCancelledText);
+	jobProgress(progress, 1, 2);
+
+	hedron.setParove();
+	jobProgress(progress, 2, 2);
+	return hedron;
+}
+// priebeh kazdych 64k cisel, ulohu je mozne zrusit aj pocas citania velkej sekcie
+static const int progressStep = 0xFFFF;
+
+Hedron importVtk(QString fileName, QString* error, JobProgress* progress)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return failed(error, "Unable to open file.");
+
+	//subor sa namapuje do pamate a cita priamo z bajtov, bez alokacie na riadok
+	qint64 size = file.size();
+	QByteArray copy;
+	const char* data = reinterpret_cast<const char*>(size > 0 ? file.map(0, size) : nullptr);
+	if (data == nullptr) {
+		copy = file.readAll();
+		data = copy.constData();
+		size = copy.size();
+	}
+	VtkScanner in(data, data + size);
+	//citanie 0 - 80 %, zostavenie siete 80 - 100 %
+	jobStage(progress, 0, 800);
+
+	//kontrola uvodnych riadkov, druhy riadok je lubovolny nazov
+	if (!in.line().startsWith("# vtk DataFile Version"))
+		return failed(error, "Hlavicka suboru nie je spravna.");
+	in.line();
+	VtkScanner::Token format = in.line();
+	bool binary = format.equals("BINARY");
+	if (!binary && !format.equals("ASCII"))
+		return failed(error, "Hlavicka suboru nie je spravna.");
+	if (!in.word().equals("DATASET") || !in.word().equals("POLYDATA"))
+		return failed(error, "Hlavicka suboru nie je spravna.");
+
+	QVector<double> points;
+	QVector<int> faceStart, faceIndices;
+	int i, j;
+	bool ok = true;
+	while (ok && !in.atEnd()) {
+		VtkScanner::Token section = in.word();
+
+		if (section.equals("POINTS")) {
+			//zapis vrcholov
+			//pocty z hlavicky sekcie sa overia proti zvysku suboru (kazde cislo aspon 1 znak) skor, nez sa podla nich alokuje
+			int vrcholySize;
+			ok = in.readInt(vrcholySize) && vrcholySize >= 0 && vrcholySize <= INT_MAX / 3;
+			VtkScanner::Token type = in.word();
+			const char* raw = nullptr;
+			bool isDouble = type.equals("double");
+			if (ok && binary) {
+				in.line();
+				raw = in.bytes(qint64(3) * vrcholySize * (isDouble ? 8 : 4));
+				ok = raw != nullptr && (isDouble || type.equals("float"));
+			}
+			else if (ok)
+				ok = qint64(3) * vrcholySize <= in.remaining();
+			if (!ok)
+				break;
+			points.resize(3 * vrcholySize);
+			double* p = points.data();
+			if (binary) {
+				for (i = 0; i < 3 * vrcholySize; i++)
+					p[i] = isDouble ? readBEDouble(raw + 8 * i) : readBEFloat(raw + 4 * i);
+			}
+			else {
+				for (i = 0; ok && i < 3 * vrcholySize; i++) {
+					ok = in.readDouble(p[i]);
+					if ((i & progressStep) == 0) {
+						jobProgress(progress, in.position() - data, size);
+						ok = ok && !jobCancelled(progress);
+					}
+				}
+			}
+		}
+		else if (section.equals("LINES") || section.equals("VERTICES") || section.equals("TRIANGLE_STRIPS")) {
+			//hrany sa odvodia zo stien, samostatne vrcholy a pasy trojuholnikov sa nenacitavaju, sekcia sa len preskoci
+			int pocet, dlzka, v;
+			ok = in.readInt(pocet) && in.readInt(dlzka);
+			if (binary) {
+				in.line();
+				ok = ok && in.bytes(qint64(4) * dlzka) != nullptr;
+			}
+			else {
+				for (i = 0; ok && i < dlzka; i++)
+					ok = in.readInt(v);
+			}
+		}
+		else if (section.equals("POLYGONS")) {
+			//zapis stien
+			int stenySize, dlzka, n;
+			ok = in.readInt(stenySize) && in.readInt(dlzka) && stenySize >= 0 && stenySize < INT_MAX && dlzka >= stenySize;
+			const char* raw = nullptr;
+			if (ok && binary) {
+				in.line();
+				raw = in.bytes(qint64(4) * dlzka);
+				ok = raw != nullptr;
+			}
+			else if (ok)
+				ok = dlzka <= in.remaining();
+			if (!ok)
+				break;
+			faceStart.resize(stenySize + 1);
+			faceIndices.resize(dlzka - stenySize);
+			int* start = faceStart.data();
+			int* indices = faceIndices.data();
+			int k = 0, r = 0;
+			start[0] = 0;
+			for (i = 0; ok && i < stenySize; i++) {
+				if (binary)
+					n = readBE32(raw + 4 * r++);
+				else
+					ok = in.readInt(n);
+				ok = ok && n >= 0 && k + n <= faceIndices.size();
+				for (j = 0; ok && j < n; j++) {
+					if (binary)
+						indices[k++] = readBE32(raw + 4 * r++);
+					else
+						ok = in.readInt(indices[k++]);
+				}
+				start[i + 1] = k;
+				if ((i & progressStep) == 0) {
+					jobProgress(progress, binary ? raw + 4 * r - data : in.position() - data, size);
+					ok = ok && !jobCancelled(progress);
+				}
+			}
+			faceIndices.resize(k);
+		}
+		else if (section.equals("POINT_DATA") || section.equals("CELL_DATA") || section.equals("FIELD"))
+			break;	//datove atributy sa nenacitavaju
+		else
+			ok = false;
+	}
+	file.close();
+	if (jobCancelled(progress))
+		return failed(error, jobCancelledText);
+	if (!ok)
+		return failed(error, "Subor je poskodeny.");
+
+	jobStage(progress, 800, 1000);
+	return buildHedron(points, faceStart, faceIndices, error, progress);
+}
+
+// hlavicka nativneho formatu: "HEDR", verzia, pocty vrcholov, polohran a stien, pocty hranicnych a nemanifoldnych polohran, rezerva
+static const char nativeMagic[4] = { 'H', 'E', 'D', 'R' };
+static const quint32 nativeVersion = 1;
+static const int nativeHeaderSize = 32;
+
+Hedron importNative(QString fileName, QString* error, JobProgress* progress)
+{
+	int i;
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return failed(error, "Unable to open file.");
+
+	qint64 size = file.size();
+	QByteArray copy;
+	const char* data = reinterpret_cast<const char*>(size > 0 ? file.map(0, size) : nullptr);
+	if (data == nullptr) {
+		copy = file.readAll();
+		data = copy.constData();
+		size = copy.size();
+	}
+
+	quint32 header[7];
+	if (size < nativeHeaderSize || memcmp(data, nativeMagic, 4) != 0)
+		return failed(error, "Hlavicka suboru nie je spravna.");
+	readLE(data + 4, header, 7);
+	if (header[0] != nativeVersion)
+		return failed(error, "Nepodporovana verzia suboru.");
+	if (header[1] == 0 || header[3] == 0 || header[1] > INT_MAX / 3 || header[2] > INT_MAX || header[3] > INT_MAX
+		|| size != nativeHeaderSize + qint64(header[1]) * (3 * 8 + 4) + qint64(header[2]) * 5 * 4 + qint64(header[3]) * 4)
+		return failed(error, "Subor je poskodeny.");
+	int vrcholySize = int(header[1]), polohranySize = int(header[2]), stenySize = int(header[3]);
+
+	//bloky su ulozene za sebou v poradi poli siete: x, y, z, hrana vrcholu, zaciatok, dalsia, predosla, par, stena, hrana steny
+	Hedron hedron;
+	hedron.resize(vrcholySize, polohranySize, stenySize);
+	const char* p = data + nativeHeaderSize;
+	readLE(p, hedron.arrayX().data(), vrcholySize); p += 8 * vrcholySize;
+	readLE(p, hedron.arrayY().data(), vrcholySize); p += 8 * vrcholySize;
+	readLE(p, hedron.arrayZ().data(), vrcholySize); p += 8 * vrcholySize;
+	readLE(p, hedron.arrayVertexEdge().data(), vrcholySize); p += 4 * vrcholySize;
+	readLE(p, hedron.arrayOrigin().data(), polohranySize); p += 4 * polohranySize;
+	readLE(p, hedron.arrayNext().data(), polohranySize); p += 4 * polohranySize;
+	readLE(p, hedron.arrayPrev().data(), polohranySize); p += 4 * polohranySize;
+	readLE(p, hedron.arrayTwin().data(), polohranySize); p += 4 * polohranySize;
+	readLE(p, hedron.arrayFace().data(), polohranySize); p += 4 * polohranySize;
+	readLE(p, hedron.arrayFaceEdge().data(), stenySize);
+	file.close();
+	if (jobCancelled(progress))
+		return failed(error, jobCancelledText);
+	jobProgress(progress, 1, 2);
+
+	//len kontrola rozsahu indexov, topologia sa neprepocitava
+	int bezParu = 0;
+	for (i = 0; i < polohranySize; i++) {
+		if (uint(hedron.origin(i)) >= uint(vrcholySize) || uint(hedron.next(i)) >= uint(polohranySize) || uint(hedron.prev(i)) >= uint(polohranySize)
+			|| (hedron.twin(i) != -1 && uint(hedron.twin(i)) >= uint(polohranySize)) || uint(hedron.face(i)) >= uint(stenySize))
+			return failed(error, "Subor je poskodeny.");
+		if (!hedron.hasPair(i))
+			bezParu++;
+	}
+	//pocty z hlavicky, ak sedia s polohranami bez paru (starsie subory maju 0), inak sa vsetky beru ako hranicne
+	if (qint64(header[4]) + header[5] == bezParu)
+		hedron.setUnpairedCounts(int(header[4]), int(header[5]));
+	else
+		hedron.setUnpairedCounts(bezParu, 0);
+	for (i = 0; i < vrcholySize; i++) {
+		if (hedron.vertexEdge(i) != -1 && uint(hedron.vertexEdge(i)) >= uint(polohranySize))
+			return failed(error, "Subor je poskodeny.");
+	}
+	for (i = 0; i < stenySize; i++) {
+		if (uint(hedron.faceEdge(i)) >= uint(polohranySize))
+			return failed(error, "Subor je poskodeny.");
+	}
+	//indexy v rozsahu este nestacia: obchadzka steny a okolo vrcholu by sa pri zle prepojenych polohranach nezastavila
+	for (i = 0; i < polohranySize; i++) {
+		int n = hedron.next(i), t = hedron.twin(i);
+		if (hedron.prev(n) != i || hedron.face(n) != hedron.face(i) || (t != -1 && hedron.twin(t) != i))
+			return failed(error, "Subor je poskodeny.");
+	}
+	for (i = 0; i < stenySize; i++) {
+		if (hedron.face(hedron.faceEdge(i)) != i)
+			return failed(error, "Subor je poskodeny.");
+	}
+	for (i = 0; i < vrcholySize; i++) {
+		if (hedron.vertexEdge(i) != -1 && hedron.origin(hedron.vertexEdge(i)) != i)
+			return failed(error, "Subor je poskodeny.");
+	}
+	jobProgress(progress, 2, 2);
+	return hedron;
+}
+Hedron importMesh(QString fileName, QString* error, JobProgress* progress)
+{
+	TRACE_SCOPE("importMesh");
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return failed(error, "Unable to open file.");
+	char magic[4] = { 0, 0, 0, 0 };
+	file.read(magic, 4);
+	file.close();
+	if (memcmp(magic, nativeMagic, 4) == 0)
+		return importNative(fileName, error, progress);
+	return importVtk(fileName, error, progress);
+}
+
+//Export functions
+
+// hrana sa zapise raz, z polohrany s mensim zaciatkom alebo z hranicnej polohrany
+static bool isLine(Hedron& hedron, int h)
+{
+	return !hedron.hasPair(h) || hedron.origin(h) <= hedron.origin(hedron.twin(h));
+}
+// cisla sa formatuju priamo do velkeho znovupouzivaneho buffera, na disk ide po blokoch
+class ChunkWriter {
+	QFile& file;
+	QByteArray buffer;
+	char* p;
+	char* end;
+	qint64 written = 0;
+	bool ok = true;
+
+	void reserve(int n) { if (end - p < n) flush(); };
+public:
+	ChunkWriter(QFile& f, int capacity = 1 << 20) : file(f) {
+		buffer.resize(capacity);
+		p = buffer.data();
+		end = p + capacity;
+	};
+	void flush() {
+		qint64 n = p - buffer.data();
+		if (n > 0 && file.write(buffer.constData(), n) != n)
+			ok = false;
+		written += n;
+		p = buffer.data();
+	};
+	bool finish() { flush(); return ok; };
+	qint64 bytes() { return written + (p - buffer.data()); };
+
+	void put(char c) { reserve(1); *p++ = c; };
+	void put(const char* s) {
+		int n = int(strlen(s));
+		if (n > end - buffer.data()) {
+			flush();
+			written += n;
+			ok = ok && file.write(s, n) == n;
+			return;
+		}
+		reserve(n);
+		memcpy(p, s, n);
+		p += n;
+	};
+	void putInt(int v) { reserve(12); p = std::to_chars(p, end, v).ptr; };
+	// najkratsi zapis, ktory sa precita spat na rovnaky float
+	void putFloat(float v) { reserve(32); p = std::to_chars(p, end, v).ptr; };
+	void putBE32(qint32 v) { reserve(4); qToBigEndian<quint32>(quint32(v), p); p += 4; };
+	void putBEFloat(float v) { quint32 u; memcpy(&u, &v, 4); reserve(4); qToBigEndian<quint32>(u, p); p += 4; };
+};
+
+// zruseny export: ciastocny subor sa zmaze
+static bool cancelExport(QFile& file, QString* error)
+{
+	file.close();
+	file.remove();
+	if (error)
+		*error = jobCancelledText;
+	return false;
+}
+
+bool exportVtk(Hedron& hedron, QString fileName, bool binary, QString* error, qint64* bytes, JobProgress* progress)
+{
+	TRACE_SCOPE("exportVtk");
+	int i;
+	if (hedron.HisEmpty()) {
+		if (error) *error = "Tvar je prazdny.";
+		return false;
+	}
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Unbuffered)) {
+		if (error) *error = "Unable to open file.";
+		return false;
+	}
+
+	int vrcholySize = hedron.getVrcholysize(), polohranySize = hedron.getHranysize(), stenySize = hedron.getStenysize();
+	int hranySize = 0;
+	for (i = 0; i < polohranySize; i++)
+		if (isLine(hedron, i)) hranySize++;
+
+	//binarne bloky su big-endian float32 / int32, za blokom nasleduje novy riadok
+	ChunkWriter out(file);
+	out.put("# vtk DataFile Version 3.0\nvtk output\n");
+	out.put(binary ? "BINARY\n" : "ASCII\n");
+	out.put("DATASET POLYDATA\nPOINTS ");
+	out.putInt(vrcholySize);
+	out.put(" float\n");
+	const double* x = hedron.arrayX().constData();
+	const double* y = hedron.arrayY().constData();
+	const double* z = hedron.arrayZ().constData();
+	//priebeh podla poctu zapisanych vrcholov, polohran a stien
+	qint64 celkom = qint64(vrcholySize) + polohranySize + stenySize;
+	for (i = 0; i < vrcholySize; i++) {
+		if ((i & progressStep) == 0) {
+			if (jobCancelled(progress))
+				return cancelExport(file, error);
+			jobProgress(progress, i, celkom);
+		}
+		if (binary) {
+			out.putBEFloat(float(x[i]));
+			out.putBEFloat(float(y[i]));
+			out.putBEFloat(float(z[i]));
+		}
+		else {
+			out.putFloat(float(x[i]));
+			out.put(' ');
+			out.putFloat(float(y[i]));
+			out.put(' ');
+			out.putFloat(float(z[i]));
+			out.put('\n');
+		}
+	}
+	if (binary) out.put('\n');
+
+	out.put("LINES ");
+	out.putInt(hranySize);
+	out.put(' ');
+	out.putInt(hranySize * 3);
+	out.put('\n');
+	for (i = 0; i < polohranySize; i++) {
+		if ((i & progressStep) == 0) {
+			if (jobCancelled(progress))
+				return cancelExport(file, error);
+			jobProgress(progress, qint64(vrcholySize) + i, celkom);
+		}
+		if (!isLine(hedron, i))
+			continue;
+		int a = hedron.origin(i), b = hedron.dest(i);
+		if (binary) {
+			out.putBE32(2);
+			out.putBE32(a);
+			out.putBE32(b);
+		}
+		else {
+			out.put("2 ");
+			out.putInt(a);
+			out.put(' ');
+			out.putInt(b);
+			out.put('\n');
+		}
+	}
+	if (binary) out.put('\n');
+
+	//kazda polohrana patri prave jednej stene, takze indexov je steny + polohrany
+	out.put("POLYGONS ");
+	out.putInt(stenySize);
+	out.put(' ');
+	out.putInt(stenySize + polohranySize);
+	out.put('\n');
+	for (i = 0; i < stenySize; i++) {
+		if ((i & progressStep) == 0) {
+			if (jobCancelled(progress))
+				return cancelExport(file, error);
+			jobProgress(progress, qint64(vrcholySize) + polohranySize + i, celkom);
+		}
+		if (binary)
+			out.putBE32(hedron.faceSize(i));
+		else
+			out.putInt(hedron.faceSize(i));
+		for (int h : hedron.faceLoop(i)) {
+			if (binary)
+				out.putBE32(hedron.origin(h));
+			else {
+				out.put(' ');
+				out.putInt(hedron.origin(h));
+			}
+		}
+		if (!binary) out.put('\n');
+	}
+	if (binary) out.put('\n');
+
+	bool ok = out.finish();
+	file.close();
+	jobProgress(progress, celkom, celkom);
+	if (bytes)
+		*bytes = out.bytes();
+	if (!ok && error)
+		*error = "Zapis do suboru zlyhal.";
+	return ok;
+}
+
+bool exportNative(Hedron& hedron, QString fileName, QString* error, qint64* bytes, JobProgress* progress)
+{
+	TRACE_SCOPE("exportNative");
+	if (hedron.HisEmpty()) {
+		if (error) *error = "Tvar je prazdny.";
+		return false;
+	}
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly)) {
+		if (error) *error = "Unable to open file.";
+		return false;
+	}
+
+	//polia siete sa zapisu tak, ako su v pamati
+	int vrcholySize = hedron.getVrcholysize(), polohranySize = hedron.getHranysize(), stenySize = hedron.getStenysize();
+	quint32 header[7] = { nativeVersion, quint32(vrcholySize), quint32(polohranySize), quint32(stenySize), quint32(hedron.getBoundaryCount()), quint32(hedron.getNonManifoldCount()), 0 };
+	QByteArray out;
+	out.reserve(nativeHeaderSize + vrcholySize * 28 + polohranySize * 20 + stenySize * 4);
+	out.append(nativeMagic, 4);
+	writeLE(out, header, 7);
+	writeLE(out, hedron.arrayX().constData(), vrcholySize);
+	writeLE(out, hedron.arrayY().constData(), vrcholySize);
+	writeLE(out, hedron.arrayZ().constData(), vrcholySize);
+	writeLE(out, hedron.arrayVertexEdge().constData(), vrcholySize);
+	writeLE(out, hedron.arrayOrigin().constData(), polohranySize);
+	writeLE(out, hedron.arrayNext().constData(), polohranySize);
+	writeLE(out, hedron.arrayPrev().constData(), polohranySize);
+	writeLE(out, hedron.arrayTwin().constData(), polohranySize);
+	writeLE(out, hedron.arrayFace().constData(), polohranySize);
+	writeLE(out, hedron.arrayFaceEdge().constData(), stenySize);
+	if (jobCancelled(progress))
+		return cancelExport(file, error);
+	jobProgress(progress, 1, 2);
+	bool ok = file.write(out) == out.size();
+	file.close();
+	jobProgress(progress, 2, 2);
+	if (bytes)
+		*bytes = out.size();
+	if (!ok && error)
+		*error = "Zapis do suboru zlyhal.";
+	return ok;
+}
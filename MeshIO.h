@@ -0,0 +1,25 @@
+#pragma once
+#include <QtCore>
+#include "Objekt.h"
+#include "Job.h"
+
+//Import functions
+//pri chybe vracaju prazdny Hedron (HisEmpty) a popis chyby v error
+//progress je nepovinny, pri zruseni ulohy sa vrati chyba jobCancelledText
+
+// VTK POLYDATA, ASCII aj BINARY (big-endian)
+Hedron importVtk(QString fileName, QString* error = nullptr, JobProgress* progress = nullptr);
+// nativny format (.hed) s ulozenou topologiou polohran, nacita sa bez prepoctu parov
+Hedron importNative(QString fileName, QString* error = nullptr, JobProgress* progress = nullptr);
+// vyberie format podla hlavicky suboru
+Hedron importMesh(QString fileName, QString* error = nullptr, JobProgress* progress = nullptr);
+
+// zostavi polohrany, steny a pary z polygonov v jednom prechode
+// points = x0 y0 z0 x1 y1 z1 ..., stena i ma vrcholy faceIndices[faceStart[i]] .. faceIndices[faceStart[i + 1] - 1]
+Hedron buildHedron(const QVector<double>& points, const QVector<int>& faceStart, const QVector<int>& faceIndices, QString* error = nullptr, JobProgress* progress = nullptr);
+
+//Export functions
+
+// bytes = pocet zapisanych bajtov, zruseny export subor zmaze
+bool exportVtk(Hedron& hedron, QString fileName, bool binary, QString* error = nullptr, qint64* bytes = nullptr, JobProgress* progress = nullptr);
+bool exportNative(Hedron& hedron, QString fileName, QString* error = nullptr, qint64* bytes = nullptr, JobProgress* progress = nullptr);
@@ -0,0 +1,143 @@
+#include "Objekt.h"
+#include "Arena.h"
+#include "Trace.h"
+
+Hedron Hedron::octahedron()
+{
+	static const double vrcholy[6][3] = { { 0.0, 0.0, 1.0 }, { -1.0, 0.0, 0.0 }, { 0.0, -1.0, 0.0 }, { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, -1.0 } };
+	static const int steny[8][3] = { { 1, 2, 0 }, { 2, 3, 0 }, { 3, 4, 0 }, { 4, 1, 0 }, { 2, 1, 5 }, { 3, 2, 5 }, { 4, 3, 5 }, { 1, 4, 5 } };
+	int i;
+	Hedron octa;
+	octa.reserve(6, 24, 8);
+	for (i = 0; i < 6; i++)
+		octa.addVertex(vrcholy[i][0], vrcholy[i][1], vrcholy[i][2]);
+	for (i = 0; i < 8; i++)
+		octa.addFace(steny[i][0], steny[i][1], steny[i][2]);
+	octa.setParove();
+	return octa;
+}
+
+void Hedron::resize(int vrcholy, int polohrany, int steny)
+{
+	X.resize(vrcholy);
+	Y.resize(vrcholy);
+	Z.resize(vrcholy);
+	VEdge.resize(vrcholy);
+	Origin.resize(polohrany);
+	Next.resize(polohrany);
+	Prev.resize(polohrany);
+	Twin.resize(polohrany);
+	Face.resize(polohrany);
+	FEdge.resize(steny);
+}
+
+void Hedron::reserve(int vrcholy, int polohrany, int steny)
+{
+	X.reserve(vrcholy);
+	Y.reserve(vrcholy);
+	Z.reserve(vrcholy);
+	VEdge.reserve(vrcholy);
+	Origin.reserve(polohrany);
+	Next.reserve(polohrany);
+	Prev.reserve(polohrany);
+	Twin.reserve(polohrany);
+	Face.reserve(polohrany);
+	FEdge.reserve(steny);
+}
+
+int Hedron::addVertex(double x, double y, double z)
+{
+	X.append(x);
+	Y.append(y);
+	Z.append(z);
+	VEdge.append(-1);
+	return X.size() - 1;
+}
+
+// trojuholnik a -> b -> c, pary sa dopocitaju v setParove
+int Hedron::addFace(int a, int b, int c)
+{
+	int f = FEdge.size(), h = Origin.size();
+	Origin << a << b << c;
+	Next << h + 1 << h + 2 << h;
+	Prev << h + 2 << h << h + 1;
+	Twin << -1 << -1 << -1;
+	Face << f << f << f;
+	FEdge.append(h);
+	VEdge[a] = h;
+	VEdge[b] = h + 1;
+	VEdge[c] = h + 2;
+	return f;
+}
+
+int Hedron::faceSize(int f) const
+{
+	int n = 0;
+	for (int h : faceLoop(f)) {
+		Q_UNUSED(h);
+		n++;
+	}
+	return n;
+}
+
+bool Hedron::setParove()
+{
+	TRACE_SCOPE("setParove");
+	int i, n = getHranysize();
+	boundaryCount = 0;
+	nonManifoldCount = 0;
+	//tabulka polohran je docasna, alokuje sa naraz v arene vlakna namiesto uzla na kazdu polohranu
+	ScratchArena& arena = ScratchArena::forThread();
+	ScratchArena::Scope scope(arena);
+	ArenaHash polohrany(arena, n);
+	for (i = 0; i < n; i++) {
+		int& j = polohrany.insert(edgeKey(Origin[i], dest(i)), i);
+		if (j != i)
+			j = -1;	// rovnako orientovana polohrana uz existuje
+	}
+	for (i = 0; i < n; i++) {
+		int a = Origin[i], b = dest(i);
+		int j = polohrany.value(edgeKey(b, a), -2);
+		if (j == -2) {
+			Twin[i] = -1;
+			boundaryCount++;
+		}
+		else if (j == -1 || polohrany.value(edgeKey(a, b), -2) == -1) {
+			Twin[i] = -1;
+			nonManifoldCount++;
+		}
+		else
+			Twin[i] = j;
+	}
+	updateVertexEdges();
+	return boundaryCount == 0 && nonManifoldCount == 0;
+}
+
+void Hedron::updateVertexEdges()
+{
+	int i, n = getHranysize();
+	VEdge.fill(-1);
+	for (i = 0; i < n; i++)
+		VEdge[Origin[i]] = i;
+	//hranicny vrchol zacina obchadzku polohranou bez paru
+	for (i = 0; i < n; i++) {
+		if (Twin[i] == -1)
+			VEdge[Origin[i]] = i;
+	}
+}
+
+void Hedron::clear()
+{
+	X.clear();
+	Y.clear();
+	Z.clear();
+	VEdge.clear();
+	Origin.clear();
+	Next.clear();
+	Prev.clear();
+	Twin.clear();
+	Face.clear();
+	FEdge.clear();
+	boundaryCount = 0;
+	nonManifoldCount = 0;
+}
@@ -1,111 +1,125 @@
 #pragma once
-#include <QtWidgets>
-
-
-class H_Edge;
-
-class Vertex {
-	int index;
-	double x, y, z;
-	H_Edge* edge;
-public:
-	Vertex() {};
-	Vertex(int i, double surX, double surY, double surZ) { index = i; x = surX; y = surY; z = surZ; };
-
-	void set(int i, double surX, double surY, double surZ) { index = i; x = surX; y = surY; z = surZ; };
-	void setEdge(H_Edge* E) { edge = E; };
-	void setSur(double surX, double surY, double surZ) {  x = surX; y = surY; z = surZ; };
-	void setIndex(int i) { index = i; };
-	void setX(double surX) { x = surX; };
-	void setY(double surY) { y = surY; };
-	void setZ(double surZ) { z = surZ; };
-
-	QString getSur() { return QString::number(x) + " " + QString::number(y) + " " + QString::number(z) + " "; };
-	int getIndex() { return index; };
-	double getX() { return x; };
-	double getY() { return y; };
-	double getZ() { return z; };
-};
-
-class Face;
-
-class H_Edge {
-	Vertex* vert_origin;
-	Vertex* vert_end;
-	Face* face;
-	H_Edge* edge_prev, * edge_next;
-	H_Edge* pair;
-public:
-	H_Edge() { face = nullptr; };
-	H_Edge(Vertex* vo, Face* f, H_Edge* ep, H_Edge* en, H_Edge* pr) { vert_origin = vo; face = f; edge_prev = ep; edge_next = en; pair = pr; };
-
-	
-	void set(Vertex* vo, Face* f, H_Edge* ep, H_Edge* en, H_Edge* pr = nullptr) { vert_origin = vo; face = f; edge_prev = ep; edge_next = en; pair = pr; };
-	void setVert(Vertex* vo, Vertex* ve) { vert_origin = vo; vert_end = ve; };
-	void setFace(Face* f) { face = f; };
-	void setEdgePrev(H_Edge* ep) { edge_prev = ep; };
-	void setEdgeNext(H_Edge* en) { edge_next = en; };
-	void setPair(H_Edge* pr) { pair = pr; };
-
-	QString PrintVrcholyHrany() { return QString::number(vert_origin->getIndex()) + " " + QString::number(edge_next->vert_origin->getIndex()) + " "; };
-	QString PrintVrcholySteny() {return QString::number(vert_origin->getIndex()) + " " +QString::number(edge_next->vert_origin->getIndex()) + " " + QString::number(edge_prev->vert_origin->getIndex());
-	};
-	Face* getStena() { return face; };
-
-	int getVOIndex() { return vert_origin->getIndex(); };
-	int getVEIndex() { return vert_end->getIndex(); };
-	H_Edge* getHrana_next() { return edge_next; };
-	H_Edge* getHrana_prev() { return edge_prev; };
-	H_Edge* getHrana_pair() { return pair; };
-};
-
-class Face {
-	H_Edge* edge=nullptr;
-public:
-	Face() {};
-	Face(H_Edge* E) { edge = E; };
-
-	void setEdge(H_Edge* E) { edge = E; };
-	H_Edge* getEdge() { return edge; };
-
-	QString PrintVrcholy() { return edge->PrintVrcholySteny(); };
-};
+#include <QtCore>
 
+// polohranova siet ulozena po poliach (structure of arrays)
+// prepojenia su int32 indexy, takze realokacia poli nic neznehodnoti
+// polohrana bez paru ma twin == -1
+class Hedron {
+	//vrcholy
+	QVector<double> X, Y, Z;
+	QVector<int> VEdge;
+	//polohrany
+	QVector<int> Origin, Next, Prev, Twin, Face;
+	//steny
+	QVector<int> FEdge;
 
+	int boundaryCount = 0, nonManifoldCount = 0;
 
-class Hedron {
-	QList<Vertex>* Vrcholy=NULL;
-	QList<H_Edge>* Hrany=NULL;
-	QList<Face>* Steny=NULL;
+	static quint64 edgeKey(int a, int b) { return (quint64(quint32(a)) << 32) | quint32(b); };
 public:
-	void setVrcholy(QList<Vertex>* vrcholy) { Vrcholy = vrcholy; };
-	void setHrany(QList<H_Edge>* hrany) { Hrany = hrany; };
-	void setSteny(QList<Face>* steny) { Steny = steny; };
-	QList<Vertex>* getVrcholy() { return Vrcholy; };
-	QList<H_Edge>* getHrany() { return Hrany; };
-	QList<Face>* getSteny() { return Steny; };
-	void setParove() {
-		int i, j;
-		for (i = 0; i < getHranysize(); i++) {
-			for (j = 0; j < getHranysize(); j++) {
-				if ((*Hrany)[i].getVOIndex() == (*Hrany)[j].getHrana_next()->getVOIndex() && (*Hrany)[i].getHrana_next()->getVOIndex() == (*Hrany)[j].getVOIndex()){
-					(*Hrany)[i].setPair(&(*Hrany)[j]);
-					(*Hrany)[j].setPair(&(*Hrany)[i]);
-				}
-			}
-		}
+	// obchadzka polohran steny: for (int h : mesh.faceLoop(f))
+	class FaceLoop {
+		const Hedron* mesh;
+		int first;
+	public:
+		class iterator {
+			const Hedron* mesh;
+			int first, h;
+		public:
+			iterator(const Hedron* m, int f, int e) { mesh = m; first = f; h = e; };
+			int operator*() const { return h; };
+			iterator& operator++() { h = mesh->next(h); if (h == first) h = -1; return *this; };
+			bool operator!=(const iterator& o) const { return h != o.h; };
+		};
+		FaceLoop(const Hedron* m, int f) { mesh = m; first = m->faceEdge(f); };
+		iterator begin() const { return iterator(mesh, first, first); };
+		iterator end() const { return iterator(mesh, first, -1); };
 	};
-	int getVrcholysize() { return Vrcholy->size(); };
-	int getHranysize() { return Hrany->size(); };
-	int getStenysize() { return Steny->size(); };
-	int getHranaOIndex(int i) { return (*Hrany)[i].getVOIndex(); };
-	int getPairHranaOIndex(int i) { return (*Hrany)[i].getHrana_pair()->getVOIndex(); };
-	QString printSur(int i) { return (*Vrcholy)[i].getSur(); };
-	QString printHrana(int i) { return (*Hrany)[i].PrintVrcholyHrany(); };
-	QString printStena(int i) { return (*Steny)[i].PrintVrcholy(); };
-	bool HisEmpty() { 
-		if (Vrcholy == NULL && Hrany == NULL && Steny == NULL) return true;
-		else return false;
+	// vychadzajuce polohrany okolo vrcholu (1-okolie): for (int h : mesh.vertexRing(v))
+	// na hranici zacina polohranou bez paru, aby sa presiel cely vejar
+	class VertexRing {
+		const Hedron* mesh;
+		int first;
+	public:
+		class iterator {
+			const Hedron* mesh;
+			int first, h;
+		public:
+			iterator(const Hedron* m, int f, int e) { mesh = m; first = f; h = e; };
+			int operator*() const { return h; };
+			iterator& operator++() { h = mesh->twin(mesh->prev(h)); if (h == first) h = -1; return *this; };
+			bool operator!=(const iterator& o) const { return h != o.h; };
+		};
+		VertexRing(const Hedron* m, int v) { mesh = m; first = m->vertexEdge(v); };
+		iterator begin() const { return iterator(mesh, first, first); };
+		iterator end() const { return iterator(mesh, first, -1); };
 	};
-	void clear() { Vrcholy->clear(); Hrany->clear(); Steny->clear(); Vrcholy = NULL; Hrany = NULL; Steny = NULL; };
+
+	static Hedron octahedron();
+
+	void resize(int vrcholy, int polohrany, int steny);
+	void reserve(int vrcholy, int polohrany, int steny);
+	int addVertex(double x, double y, double z);
+	int addFace(int a, int b, int c);
+
+	//vrcholy
+	double x(int v) const { return X[v]; };
+	double y(int v) const { return Y[v]; };
+	double z(int v) const { return Z[v]; };
+	void setSur(int v, double x, double y, double z) { X[v] = x; Y[v] = y; Z[v] = z; };
+	int vertexEdge(int v) const { return VEdge[v]; };
+	VertexRing vertexRing(int v) const { return VertexRing(this, v); };
+
+	//polohrany
+	int origin(int h) const { return Origin[h]; };
+	int dest(int h) const { return Origin[Next[h]]; };
+	int next(int h) const { return Next[h]; };
+	int prev(int h) const { return Prev[h]; };
+	int twin(int h) const { return Twin[h]; };
+	int face(int h) const { return Face[h]; };
+	void setEdge(int h, int origin, int face, int prev, int next, int twin = -1) { Origin[h] = origin; Face[h] = face; Prev[h] = prev; Next[h] = next; Twin[h] = twin; };
+	bool hasPair(int h) const { return Twin[h] != -1; };
+
+	//steny
+	int faceEdge(int f) const { return FEdge[f]; };
+	void setFaceEdge(int f, int h) { FEdge[f] = h; };
+	FaceLoop faceLoop(int f) const { return FaceLoop(this, f); };
+	int faceSize(int f) const;
+
+	// priamy pristup k poliam pre hromadne citanie a zapis
+	QVector<double>& arrayX() { return X; };
+	QVector<double>& arrayY() { return Y; };
+	QVector<double>& arrayZ() { return Z; };
+	QVector<int>& arrayVertexEdge() { return VEdge; };
+	QVector<int>& arrayOrigin() { return Origin; };
+	QVector<int>& arrayNext() { return Next; };
+	QVector<int>& arrayPrev() { return Prev; };
+	QVector<int>& arrayTwin() { return Twin; };
+	QVector<int>& arrayFace() { return Face; };
+	QVector<int>& arrayFaceEdge() { return FEdge; };
+	const QVector<double>& arrayX() const { return X; };
+	const QVector<double>& arrayY() const { return Y; };
+	const QVector<double>& arrayZ() const { return Z; };
+	const QVector<int>& arrayVertexEdge() const { return VEdge; };
+	const QVector<int>& arrayOrigin() const { return Origin; };
+	const QVector<int>& arrayNext() const { return Next; };
+	const QVector<int>& arrayPrev() const { return Prev; };
+	const QVector<int>& arrayTwin() const { return Twin; };
+	const QVector<int>& arrayFace() const { return Face; };
+	const QVector<int>& arrayFaceEdge() const { return FEdge; };
+
+	// parovanie polohran cez hash (zaciatok, koniec) -> polohrana, ocakavany linearny cas
+	// vrati false, ak ma siet hranicne alebo nemanifoldne hrany (tie ostanu bez paru)
+	bool setParove();
+	// po priamom nastaveni parov (bez setParove): hranicne vrcholy a pocty polohran bez paru
+	void updateVertexEdges();
+	void setUnpairedCounts(int boundary, int nonManifold) { boundaryCount = boundary; nonManifoldCount = nonManifold; };
+	int getBoundaryCount() const { return boundaryCount; };
+	int getNonManifoldCount() const { return nonManifoldCount; };
+
+	int getVrcholysize() const { return X.size(); };
+	int getHranysize() const { return Origin.size(); };
+	int getStenysize() const { return FEdge.size(); };
+	bool HisEmpty() const { return X.isEmpty() && Origin.isEmpty() && FEdge.isEmpty(); };
+	void clear();
 };
@@ -0,0 +1,25 @@
+#pragma once
+#include <QtCore>
+#include <QtConcurrent>
+
+// pocet suvislych kusov pre n prvkov: najviac threads, kazdy aspon minChunk prvkov
+inline int parallelChunkCount(int n, int threads, int minChunk = 4096)
+{
+	return qMax(1, qMin(threads, n / minChunk));
+}
+
+// rozsah 0..n po suvislych kusoch, kus t vola f(t, od, po), prvy kus pocita volajuce vlakno
+// hranice kusov zavisia len od n a kusy, vysledok po kusoch je preto rovnaky pri kazdom behu
+template <typename F> void parallelChunks(int n, int kusy, F f)
+{
+	if (kusy <= 1) {
+		f(0, 0, n);
+		return;
+	}
+	QVector<QFuture<void>> vlakna;
+	for (int t = 1; t < kusy; t++)
+		vlakna.append(QtConcurrent::run([=]() { f(t, int(qint64(n) * t / kusy), int(qint64(n) * (t + 1) / kusy)); }));
+	f(0, 0, n / kusy);
+	for (QFuture<void>& v : vlakna)
+		v.waitForFinished();
+}
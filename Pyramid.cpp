@@ -0,0 +1,183 @@
+#include "Pyramid.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PYRAMID_SSE2
+#include <emmintrin.h>
+#endif
+
+void downsample2x2(const uchar* src, qint64 srcStride, int srcW, int srcH, uchar* dst, qint64 dstStride)
+{
+	int dstW = (srcW + 1) / 2, dstH = (srcH + 1) / 2, pary = srcW / 2;
+	for (int y = 0; y < dstH; y++) {
+		const uchar* r0 = src + 2 * y * srcStride;
+		const uchar* r1 = 2 * y + 1 < srcH ? r0 + srcStride : r0;
+		uchar* d = dst + y * dstStride;
+		int x = 0;
+#ifdef PYRAMID_SSE2
+		//4 ciele z 8 pixelov v dvoch riadkoch: kanaly na 16 bitov, parne + neparne pixely, (sucet + 2) >> 2
+		__m128i zero = _mm_setzero_si128(), dva = _mm_set1_epi16(2);
+		for (; x + 4 <= pary; x += 4) {
+			__m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r0 + 8 * x));
+			__m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r0 + 8 * x + 16));
+			__m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r1 + 8 * x));
+			__m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r1 + 8 * x + 16));
+			//stlpcove sucty pixelov 0-1, 2-3, 4-5, 6-7
+			__m128i s01 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+			__m128i s23 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+			__m128i s45 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+			__m128i s67 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+			__m128i c01 = _mm_add_epi16(_mm_unpacklo_epi64(s01, s23), _mm_unpackhi_epi64(s01, s23));
+			__m128i c23 = _mm_add_epi16(_mm_unpacklo_epi64(s45, s67), _mm_unpackhi_epi64(s45, s67));
+			c01 = _mm_srli_epi16(_mm_add_epi16(c01, dva), 2);
+			c23 = _mm_srli_epi16(_mm_add_epi16(c23, dva), 2);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(d + 4 * x), _mm_packus_epi16(c01, c23));
+		}
+#endif
+		for (; x < dstW; x++) {
+			//posledny stlpec pri neparnej sirke sa zdvoji
+			int x1 = 2 * x + 1 < srcW ? 2 * x + 1 : 2 * x;
+			for (int c = 0; c < 4; c++)
+				d[4 * x + c] = uchar((r0[8 * x + c] + r0[4 * x1 + c] + r1[8 * x + c] + r1[4 * x1 + c] + 2) >> 2);
+		}
+	}
+}
+
+void MipPyramid::reset(QSize canvasSize)
+{
+	levels.clear();
+	stamp++;
+	QSize s = canvasSize.isValid() ? canvasSize : QSize(0, 0);
+	while (s.width() > tileSize || s.height() > tileSize) {
+		s = QSize((s.width() + 1) / 2, (s.height() + 1) / 2);
+		Level level;
+		level.size = s;
+		level.tilesX = (s.width() + tileSize - 1) / tileSize;
+		level.tilesY = (s.height() + tileSize - 1) / tileSize;
+		int n = level.tilesX * level.tilesY;
+		level.tiles.resize(n);
+		level.valid.fill(false, n);
+		level.version.fill(stamp, n);
+		levels.append(level);
+	}
+}
+
+void MipPyramid::invalidate(QRect area)
+{
+	if (area.isEmpty())
+		return;
+	stamp++;
+	for (int k = 1; k <= levels.size(); k++) {
+		Level& level = levels[k - 1];
+		QRect cast = QRect(QPoint(area.left() >> k, area.top() >> k), QPoint(area.right() >> k, area.bottom() >> k)).intersected(QRect(QPoint(0, 0), level.size));
+		if (cast.isEmpty())
+			break;
+		for (int ty = cast.top() / tileSize; ty <= cast.bottom() / tileSize; ty++) {
+			for (int tx = cast.left() / tileSize; tx <= cast.right() / tileSize; tx++) {
+				level.valid[ty * level.tilesX + tx] = false;
+				level.version[ty * level.tilesX + tx] = stamp;
+			}
+		}
+	}
+}
+
+void MipPyramid::invalidateAll()
+{
+	stamp++;
+	for (Level& level : levels) {
+		level.valid.fill(false);
+		level.version.fill(stamp);
+	}
+}
+
+void MipPyramid::draw(QPainter& painter, int k, QRect area, QRgb fill, QVector<int>& missing) const
+{
+	const Level& level = levels[k - 1];
+	area = area.intersected(QRect(QPoint(0, 0), level.size));
+	if (area.isEmpty())
+		return;
+	for (int ty = area.top() / tileSize; ty <= area.bottom() / tileSize; ty++) {
+		for (int tx = area.left() / tileSize; tx <= area.right() / tileSize; tx++) {
+			int t = ty * level.tilesX + tx;
+			QRect r = level.tileRect(t), cast = r.intersected(area);
+			if (!level.valid[t])
+				missing.append(t);
+			if (!level.tiles[t].isNull()) {
+				painter.drawImage(cast, level.tiles[t], cast.translated(-r.topLeft()));
+				continue;
+			}
+			//dlazdica hrubsej urovne j pokryva celu dlazdicu urovne k
+			bool hotovo = false;
+			for (int j = k + 1; j <= levels.size() && !hotovo; j++) {
+				const Level& hrubsia = levels[j - 1];
+				int h = (ty >> (j - k)) * hrubsia.tilesX + (tx >> (j - k));
+				if (hrubsia.tiles[h].isNull())
+					continue;
+				qreal f = 1 << (j - k);
+				QRect hr = hrubsia.tileRect(h);
+				painter.drawImage(QRectF(cast), hrubsia.tiles[h], QRectF(cast.x() / f - hr.x(), cast.y() / f - hr.y(), cast.width() / f, cast.height() / f));
+				hotovo = true;
+			}
+			if (!hotovo)
+				painter.fillRect(cast, QColor::fromRgba(fill));
+		}
+	}
+}
+
+void MipPyramid::buildTile(const TiledCanvas& canvas, QVector<Level>& levels, int k, int t)
+{
+	QRect r = levels[k - 1].tileRect(t);
+	int tx = t % levels[k - 1].tilesX, ty = t / levels[k - 1].tilesX;
+	QImage out(r.size(), QImage::Format_ARGB32);
+	for (int cy = 2 * ty; cy <= 2 * ty + 1; cy++) {
+		for (int cx = 2 * tx; cx <= 2 * tx + 1; cx++) {
+			QImage child;
+			if (k == 1) {
+				QRect cr = QRect(cx * tileSize, cy * tileSize, tileSize, tileSize).intersected(QRect(QPoint(0, 0), canvas.getSize()));
+				if (cr.isEmpty())
+					continue;
+				child = canvas.toImage(cr);
+			}
+			else {
+				const Level& jemnejsia = levels[k - 2];
+				if (cx >= jemnejsia.tilesX || cy >= jemnejsia.tilesY)
+					continue;
+				int c = cy * jemnejsia.tilesX + cx;
+				if (!jemnejsia.valid[c])
+					buildTile(canvas, levels, k - 1, c);
+				child = levels[k - 2].tiles[c];
+			}
+			//kazda zo styroch dlazdic dava jeden kvadrant
+			uchar* d = out.scanLine((cy - 2 * ty) * tileSize / 2) + 4 * ((cx - 2 * tx) * tileSize / 2);
+			downsample2x2(child.constBits(), child.bytesPerLine(), child.width(), child.height(), d, out.bytesPerLine());
+		}
+	}
+	levels[k - 1].tiles[t] = out;
+	levels[k - 1].valid[t] = true;
+}
+
+QVector<MipPyramid::Level> MipPyramid::build(TiledCanvas canvas, QVector<Level> levels, int k, QVector<int> tiles)
+{
+	for (int t : tiles) {
+		if (!levels[k - 1].valid[t])
+			buildTile(canvas, levels, k, t);
+	}
+	return levels;
+}
+
+void MipPyramid::merge(const QVector<Level>& built)
+{
+	if (built.size() != levels.size())
+		return;
+	for (int k = 0; k < levels.size(); k++) {
+		Level& level = levels[k];
+		const Level& b = built[k];
+		if (b.size != level.size)
+			return;
+		for (int t = 0; t < level.tiles.size(); t++) {
+			if (!level.valid[t] && b.valid[t] && b.version[t] == level.version[t]) {
+				level.tiles[t] = b.tiles[t];
+				level.valid[t] = true;
+			}
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <QtGui>
+#include "Canvas.h"
+
+// zmensene kopie TiledCanvas na zobrazenie pri oddialeni, uroven k ma rozlisenie 1/2^k (uroven 0 je platno)
+// dlazdica urovne k je priemer 2x2 zo styroch dlazdic urovne k - 1, pocita sa az ked je treba ju zobrazit
+// kreslenie do platna dlazdice len zneplatni, do prepocitania sa zobrazuju so starym obsahom
+class MipPyramid {
+public:
+	static const int tileSize = TiledCanvas::tileSize;
+	struct Level {
+		QSize size;
+		int tilesX = 0, tilesY = 0;
+		QVector<QImage> tiles;		// null = este nevypocitana
+		QVector<bool> valid;
+		QVector<quint32> version;	// nova pri kazdom zneplatneni
+		QRect tileRect(int t) const { return QRect((t % tilesX) * tileSize, (t / tilesX) * tileSize, tileSize, tileSize).intersected(QRect(QPoint(0, 0), size)); };
+	};
+private:
+	QVector<Level> levels;		// levels[k - 1] je uroven k
+	quint32 stamp = 0;			// posledna pridelena verzia, po reset sa ziadna neopakuje
+
+	static void buildTile(const TiledCanvas& canvas, QVector<Level>& levels, int k, int t);
+public:
+	// urovne az po tu, ktora sa zmesti do jednej dlazdice, vsetky nevypocitane
+	void reset(QSize canvasSize);
+	int getLevels() const { return levels.size(); };
+	QSize levelSize(int k) const { return k == 0 || k > levels.size() ? QSize() : levels[k - 1].size; };
+
+	// area v suradniciach platna
+	void invalidate(QRect area);
+	void invalidateAll();
+
+	// vykreslenie oblasti area urovne k (jej suradnice); nevypocitane dlazdice sa kreslia zvacsene z hrubsej urovne
+	// alebo farbou fill, neplatne dlazdice tejto urovne v area sa pridaju do missing
+	void draw(QPainter& painter, int k, QRect area, QRgb fill, QVector<int>& missing) const;
+
+	// vypocet dlazdic tiles urovne k nad kopiami platna a urovni (mimo GUI vlakna), vrati prepocitane urovne
+	static QVector<Level> build(TiledCanvas canvas, QVector<Level> levels, int k, QVector<int> tiles);
+	QVector<Level> snapshot() const { return levels; };
+	// prevezme vypocitane dlazdice, ktore sa od snapshot nezneplatnili
+	void merge(const QVector<Level>& built);
+};
+
+// priemer blokov 2x2 pixelov ARGB32 (zaokruhleny), pri neparnom rozmere sa posledny stlpec / riadok zdvoji
+// cielovy obrazok ma rozmery (srcW + 1) / 2 x (srcH + 1) / 2
+void downsample2x2(const uchar* src, qint64 srcStride, int srcW, int srcH, uchar* dst, qint64 dstStride);
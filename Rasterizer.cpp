@@ -0,0 +1,251 @@
+#include "Rasterizer.h"
+#include <QtConcurrent>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+QVector3D Camera::eye() const
+{
+	float az = qDegreesToRadians(azimuth), el = qDegreesToRadians(elevation);
+	return QVector3D(distance * cos(el) * cos(az), distance * cos(el) * sin(az), distance * sin(el));
+}
+
+QMatrix4x4 Camera::viewMatrix() const
+{
+	QMatrix4x4 m;
+	m.lookAt(eye(), QVector3D(0.0f, 0.0f, 0.0f), QVector3D(0.0f, 0.0f, 1.0f));
+	return m;
+}
+
+QMatrix4x4 Camera::projectionMatrix(float aspect) const
+{
+	QMatrix4x4 m;
+	m.perspective(fov, aspect, 0.05f * distance, 10.0f * distance);
+	return m;
+}
+
+// normala vrcholu = normalizovany sucet normal okolitych stien (vahovany plochou)
+// nezavisi od kamery, prepocita sa len pre inu siet
+void Rasterizer::computeNormals(const Hedron& mesh)
+{
+	NormalsKey key = { mesh.arrayX().constData(), mesh.arrayOrigin().constData(), mesh.getVrcholysize(), mesh.getHranysize() };
+	if (normalsValid && key.positions == normalsKey.positions && key.origins == normalsKey.origins
+		&& key.vertices == normalsKey.vertices && key.halfEdges == normalsKey.halfEdges)
+		return;
+	normalsKey = key;
+	normalsValid = true;
+
+	int n = mesh.getVrcholysize();
+	nx.fill(0.0f, n);
+	ny.fill(0.0f, n);
+	nz.fill(0.0f, n);
+	for (int f = 0; f < mesh.getStenysize(); f++) {
+		int e0 = mesh.faceEdge(f), a = mesh.origin(e0);
+		for (int h = mesh.next(e0); mesh.next(h) != e0; h = mesh.next(h)) {
+			int b = mesh.origin(h), c = mesh.dest(h);
+			double ux = mesh.x(b) - mesh.x(a), uy = mesh.y(b) - mesh.y(a), uz = mesh.z(b) - mesh.z(a);
+			double wx = mesh.x(c) - mesh.x(a), wy = mesh.y(c) - mesh.y(a), wz = mesh.z(c) - mesh.z(a);
+			float px = float(uy * wz - uz * wy), py = float(uz * wx - ux * wz), pz = float(ux * wy - uy * wx);
+			for (int v : { a, b, c }) {
+				nx[v] += px;
+				ny[v] += py;
+				nz[v] += pz;
+			}
+		}
+	}
+	for (int v = 0; v < n; v++) {
+		float d = sqrt(nx[v] * nx[v] + ny[v] * ny[v] + nz[v] * nz[v]);
+		if (d > 0.0f) {
+			nx[v] /= d;
+			ny[v] /= d;
+			nz[v] /= d;
+		}
+	}
+}
+
+// intenzita podla Lambertovho zakona
+void Rasterizer::shadeVertices(const Hedron& mesh, const QVector3D& light)
+{
+	computeNormals(mesh);
+	int n = mesh.getVrcholysize();
+	svetlo.resize(n);
+	for (int v = 0; v < n; v++) {
+		float l = nx[v] * light.x() + ny[v] * light.y() + nz[v] * light.z();
+		svetlo[v] = 0.15f + 0.85f * qMax(0.0f, l);
+	}
+}
+
+float Rasterizer::shadeFace(const Hedron& mesh, int f, const QVector3D& light) const
+{
+	int e0 = mesh.faceEdge(f);
+	int a = mesh.origin(e0), b = mesh.dest(e0), c = mesh.origin(mesh.prev(e0));
+	double ux = mesh.x(b) - mesh.x(a), uy = mesh.y(b) - mesh.y(a), uz = mesh.z(b) - mesh.z(a);
+	double wx = mesh.x(c) - mesh.x(a), wy = mesh.y(c) - mesh.y(a), wz = mesh.z(c) - mesh.z(a);
+	QVector3D normala(float(uy * wz - uz * wy), float(uz * wx - ux * wz), float(ux * wy - uy * wx));
+	normala.normalize();
+	return 0.15f + 0.85f * qMax(0.0f, QVector3D::dotProduct(normala, light));
+}
+
+static const int tileSize = 64;
+
+// suradnica na obrazovke sa pred prevodom na int oreze na <lo, hi> (prevod nekonecna alebo
+// vrcholu daleko mimo obrazovky by bol nedefinovany), NaN skonci na lo
+static int floorClamped(float v, int lo, int hi) { return int(floor(qBound(float(lo), v, float(hi)))); }
+static int ceilClamped(float v, int lo, int hi) { return int(ceil(qBound(float(lo), v, float(hi)))); }
+
+// triedenie trojuholnikov do dlazdic podla obalovaho obdlznika (pocitanie, prefixovy sucet, zapis)
+// v kazdej dlazdici zostane poradie trojuholnikov ako v sieti
+void Rasterizer::binTriangles(int tilesX, int tilesY)
+{
+	int t, n = triangles.size();
+	binStart.fill(0, tilesX * tilesY + 1);
+	auto rozsah = [&](const Triangle& tr, int& tx0, int& tx1, int& ty0, int& ty1) {
+		tx0 = qBound(0, floorClamped(qMin(tr.x[0], qMin(tr.x[1], tr.x[2])), 0, tilesX * tileSize) / tileSize, tilesX - 1);
+		tx1 = qBound(0, ceilClamped(qMax(tr.x[0], qMax(tr.x[1], tr.x[2])), 0, tilesX * tileSize) / tileSize, tilesX - 1);
+		ty0 = qBound(0, floorClamped(qMin(tr.y[0], qMin(tr.y[1], tr.y[2])), 0, tilesY * tileSize) / tileSize, tilesY - 1);
+		ty1 = qBound(0, ceilClamped(qMax(tr.y[0], qMax(tr.y[1], tr.y[2])), 0, tilesY * tileSize) / tileSize, tilesY - 1);
+	};
+	int tx0, tx1, ty0, ty1;
+	for (t = 0; t < n; t++) {
+		rozsah(triangles[t], tx0, tx1, ty0, ty1);
+		for (int ty = ty0; ty <= ty1; ty++)
+			for (int tx = tx0; tx <= tx1; tx++)
+				binStart[ty * tilesX + tx + 1]++;
+	}
+	for (t = 0; t < tilesX * tilesY; t++)
+		binStart[t + 1] += binStart[t];
+	binList.resize(binStart.last());
+	QVector<int> kurzor = binStart;
+	for (t = 0; t < n; t++) {
+		rozsah(triangles[t], tx0, tx1, ty0, ty1);
+		for (int ty = ty0; ty <= ty1; ty++)
+			for (int tx = tx0; tx <= tx1; tx++)
+				binList[kurzor[ty * tilesX + tx]++] = t;
+	}
+}
+
+// hranove funkcie nad obalovym obdlznikom orezanym na dlazdicu, z-buffer dlazdice sa zmesti do L1 cache
+void Rasterizer::renderTile(uchar* bits, qint64 bytesPerLine, int width, int height, int tilesX, int tile) const
+{
+	int tileX = (tile % tilesX) * tileSize, tileY = (tile / tilesX) * tileSize;
+	int tileW = qMin(tileSize, width - tileX), tileH = qMin(tileSize, height - tileY);
+	float hlbka[tileSize * tileSize];
+	for (int k = 0; k < tileSize * tileSize; k++)
+		hlbka[k] = std::numeric_limits<float>::infinity();
+	for (int y = 0; y < tileH; y++) {
+		QRgb* riadok = reinterpret_cast<QRgb*>(bits + (tileY + y) * bytesPerLine) + tileX;
+		for (int x = 0; x < tileW; x++)
+			riadok[x] = background;
+	}
+
+	int r = qRed(color), g = qGreen(color), b = qBlue(color);
+	for (int k = binStart[tile]; k < binStart[tile + 1]; k++) {
+		const Triangle& tr = triangles[binList[k]];
+		float x0 = tr.x[0], y0 = tr.y[0], x1 = tr.x[1], y1 = tr.y[1], x2 = tr.x[2], y2 = tr.y[2];
+		int minX = qMax(tileX, floorClamped(qMin(x0, qMin(x1, x2)), tileX - 1, tileX + tileW));
+		int maxX = qMin(tileX + tileW - 1, ceilClamped(qMax(x0, qMax(x1, x2)), tileX - 1, tileX + tileW));
+		int minY = qMax(tileY, floorClamped(qMin(y0, qMin(y1, y2)), tileY - 1, tileY + tileH));
+		int maxY = qMin(tileY + tileH - 1, ceilClamped(qMax(y0, qMax(y1, y2)), tileY - 1, tileY + tileH));
+		if (minX > maxX || minY > maxY)
+			continue;
+
+		float area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+		float invArea = 1.0f / area;
+
+		//w0 patri vrcholu 0 (hrana 1-2), w1 vrcholu 1 (hrana 2-0), w2 vrcholu 2 (hrana 0-1)
+		float px = minX + 0.5f, py = minY + 0.5f;
+		float w0Row = (x2 - x1) * (py - y1) - (y2 - y1) * (px - x1);
+		float w1Row = (x0 - x2) * (py - y2) - (y0 - y2) * (px - x2);
+		float w2Row = (x1 - x0) * (py - y0) - (y1 - y0) * (px - x0);
+		float a0 = -(y2 - y1), a1 = -(y0 - y2), a2 = -(y1 - y0);
+		float b0 = x2 - x1, b1 = x0 - x2, b2 = x1 - x0;
+		for (int y = minY; y <= maxY; y++) {
+			QRgb* riadok = reinterpret_cast<QRgb*>(bits + y * bytesPerLine);
+			float* h = hlbka + (y - tileY) * tileSize - tileX;
+			float w0 = w0Row, w1 = w1Row, w2 = w2Row;
+			for (int x = minX; x <= maxX; x++) {
+				if (w0 >= 0.0f && w1 >= 0.0f && w2 >= 0.0f) {
+					float l0 = w0 * invArea, l1 = w1 * invArea, l2 = w2 * invArea;
+					float z = l0 * tr.z[0] + l1 * tr.z[1] + l2 * tr.z[2];
+					if (z < h[x]) {
+						h[x] = z;
+						float s = l0 * tr.i[0] + l1 * tr.i[1] + l2 * tr.i[2];
+						riadok[x] = qRgb(int(r * s), int(g * s), int(b * s));
+					}
+				}
+				w0 += a0;
+				w1 += a1;
+				w2 += a2;
+			}
+			w0Row += b0;
+			w1Row += b1;
+			w2Row += b2;
+		}
+	}
+}
+
+bool Rasterizer::render(const Hedron& mesh, const Camera& camera, QImage& image)
+{
+	if (image.format() != QImage::Format_ARGB32 && image.format() != QImage::Format_RGB32)
+		return false;
+	int width = image.width(), height = image.height();
+	if (width == 0 || height == 0)
+		return true;
+
+	triangles.resize(0);
+	if (!mesh.HisEmpty()) {
+		QMatrix4x4 mvp = camera.projectionMatrix(float(width) / height) * camera.viewMatrix();
+		transformVertices(mesh.arrayX().constData(), mesh.arrayY().constData(), mesh.arrayZ().constData(), mesh.getVrcholysize(),
+			mvp.constData(), width, height, screen, kernel);
+		const float* sx = screen.x.constData();
+		const float* sy = screen.y.constData();
+		const float* sz = screen.z.constData();
+		const uchar* clip = screen.clip.constData();
+		QVector3D light = camera.eye().normalized();
+		if (shading == Gouraud)
+			shadeVertices(mesh, light);
+
+		for (int f = 0; f < mesh.getStenysize(); f++) {
+			int e0 = mesh.faceEdge(f), a = mesh.origin(e0);
+			float faceLight = shading == Flat ? shadeFace(mesh, f, light) : 0.0f;
+			for (int h = mesh.next(e0); mesh.next(h) != e0; h = mesh.next(h)) {
+				int v[3] = { a, mesh.origin(h), mesh.dest(h) };
+				//trojuholnik s vrcholom blizsie ako blizka rovina sa neoreze, ale vynecha, rovnako ako trojuholnik cely mimo jednej roviny
+				if (((clip[v[0]] | clip[v[1]] | clip[v[2]]) & ClipNear) || (clip[v[0]] & clip[v[1]] & clip[v[2]]))
+					continue;
+				//stena otocena ku kamere je v obraze (y nadol) v smere hodinovych ruciciek, ma zapornu plochu
+				float area = (sx[v[1]] - sx[v[0]]) * (sy[v[2]] - sy[v[0]]) - (sx[v[2]] - sx[v[0]]) * (sy[v[1]] - sy[v[0]]);
+				if (area >= 0.0f)
+					continue;
+				qSwap(v[1], v[2]);
+				Triangle tr;
+				for (int k = 0; k < 3; k++) {
+					tr.x[k] = sx[v[k]];
+					tr.y[k] = sy[v[k]];
+					tr.z[k] = sz[v[k]];
+					tr.i[k] = shading == Gouraud ? svetlo[v[k]] : faceLight;
+				}
+				triangles.append(tr);
+			}
+		}
+	}
+
+	int tilesX = (width + tileSize - 1) / tileSize, tilesY = (height + tileSize - 1) / tileSize, tileCount = tilesX * tilesY;
+	binTriangles(tilesX, tilesY);
+
+	//dlazdice si vlakna beru postupne, aby sa zatazenie vyrovnalo; do obrazka zapisuje kazda dlazdica len svoju cast
+	uchar* bits = image.bits();
+	qint64 bytesPerLine = image.bytesPerLine();
+	std::atomic<int> dalsia(0);
+	auto kresli = [&]() {
+		for (int t = dalsia++; t < tileCount; t = dalsia++)
+			renderTile(bits, bytesPerLine, width, height, tilesX, t);
+	};
+	QVector<QFuture<void>> vlakna;
+	for (int k = 1; k < qMin(threadCount, tileCount); k++)
+		vlakna.append(QtConcurrent::run(kresli));
+	kresli();
+	for (QFuture<void>& v : vlakna)
+		v.waitForFinished();
+	return true;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <QtGui>
+#include "Objekt.h"
+#include "Transform.h"
+
+// kamera obieha okolo pociatku, os z smeruje hore, uhly su v stupnoch
+struct Camera {
+	float azimuth = 30.0f, elevation = 20.0f;
+	float distance = 3.5f, fov = 45.0f;
+
+	QVector3D eye() const;
+	QMatrix4x4 viewMatrix() const;
+	QMatrix4x4 projectionMatrix(float aspect) const;
+};
+
+// softverove vykreslenie siete priamo do riadkov QImage (Format_ARGB32 alebo Format_RGB32), bez QPainter
+// perspektivna projekcia, float z-buffer, odvratene steny sa vynechaju, konstantne alebo Gouraudovo tienovanie
+// svetlo svieti zo smeru kamery, n-uholniky sa kreslia ako vejar trojuholnikov
+// obraz sa deli na dlazdice 64x64, trojuholniky sa roztriedia do dlazdic a dlazdice sa kreslia paralelne,
+// kazda s vlastnym z-bufferom; vysledok nezavisi od poctu vlakien
+class Rasterizer {
+public:
+	enum Shading { Flat, Gouraud };
+private:
+	Shading shading = Gouraud;
+	QRgb background = qRgb(255, 255, 255), color = qRgb(70, 130, 200);
+
+	// viditelny trojuholnik v obrazovkovych suradniciach, vrcholy v poradi s kladnou plochou
+	struct Triangle {
+		float x[3], y[3], z[3], i[3];
+	};
+
+	int threadCount;
+	//buffre sa pouzivaju opakovane, kazda snimka len prepise obsah
+	ScreenVertices screen;
+	QVector<float> nx, ny, nz, svetlo;
+	// normaly patria sieti s tymito poliami, nova siet alebo zmenena kopia ma polia na inych adresach
+	struct NormalsKey {
+		const void* positions;
+		const void* origins;
+		int vertices, halfEdges;
+	};
+	NormalsKey normalsKey;
+	bool normalsValid = false;
+	TransformKernel kernel = bestTransformKernel();
+	QVector<Triangle> triangles;
+	QVector<int> binStart, binList;	// trojuholniky dlazdice t su binList[binStart[t] .. binStart[t + 1] - 1]
+
+	void computeNormals(const Hedron& mesh);
+	void shadeVertices(const Hedron& mesh, const QVector3D& light);
+	float shadeFace(const Hedron& mesh, int f, const QVector3D& light) const;
+	void binTriangles(int tilesX, int tilesY);
+	void renderTile(uchar* bits, qint64 bytesPerLine, int width, int height, int tilesX, int tile) const;
+public:
+	Rasterizer(int threads = QThread::idealThreadCount()) { setThreadCount(threads); };
+	void setThreadCount(int threads) { threadCount = qMax(1, threads); };
+	int getThreadCount() const { return threadCount; };
+
+	void setShading(Shading s) { shading = s; };
+	Shading getShading() const { return shading; };
+	void setColor(QRgb c) { color = c; };
+	void setBackground(QRgb c) { background = c; };
+	void setTransformKernel(TransformKernel k) { kernel = k; };
+	// po zmene vrcholov siete na mieste (bez kopie) sa normaly musia prepocitat
+	void invalidateNormals() { normalsValid = false; };
+
+	// vrati false, ak obrazok nema 32-bitovy format
+	bool render(const Hedron& mesh, const Camera& camera, QImage& image);
+};
@@ -0,0 +1,370 @@
+#include "Subdivision.h"
+#include "Arena.h"
+#include "Trace.h"
+#include "Parallel.h"
+#include <cmath>
+#include <climits>
+
+// stena f sa rozdeli na (v0, A, B), (A, v1, C), (B, C, v2), (B, A, C), kazda ma 3 polohrany za sebou
+// rodicovska polohrana na pozicii k v stene (0 = hrana steny, 1 = dalsia, 2 = predosla)
+// ma prvu polovicu (zaciatok -> stred) na 12f + firstHalf[k] a druhu (stred -> koniec) na 12f + secondHalf[k]
+static const int firstHalf[3] = { 0, 4, 8 };
+static const int secondHalf[3] = { 3, 7, 2 };
+// stredy vznikaju po stenach v poradi A (pozicia 0), B (pozicia 2), C (pozicia 1)
+static const int poradieSlotu[3] = { 0, 2, 1 };
+
+static int edgeSlot(const Hedron& mesh, int h)
+{
+	int e0 = mesh.faceEdge(mesh.face(h));
+	if (h == e0) return 0;
+	if (h == mesh.next(e0)) return 1;
+	return 2;
+}
+
+// poradie polohrany pri vytvarani stredov, ako keby sa steny prechadzali postupne
+static int edgeRank(const Hedron& mesh, int h)
+{
+	return 3 * mesh.face(h) + poradieSlotu[edgeSlot(mesh, h)];
+}
+
+// k-ta polohrana steny v poradi vytvarania stredov
+static int edgeAt(const Hedron& mesh, int f, int k)
+{
+	int e0 = mesh.faceEdge(f);
+	return k == 0 ? e0 : (k == 1 ? mesh.prev(e0) : mesh.next(e0));
+}
+
+// rozsah 0..n sa rozdeli na suvisle kusy (Parallel.h), prvy kus pocita volajuce vlakno
+int SubdivisionEngine::chunkCount(int n) const
+{
+	return parallelChunkCount(n, threadCount);
+}
+
+template <typename F> void SubdivisionEngine::parallelFor(int n, F f) const
+{
+	parallelChunks(n, chunkCount(n), f);
+}
+
+// zrusena uloha, vysledok sa zahodi
+static Hedron cancelled(QString* error)
+{
+	if (error)
+		*error = jobCancelledText;
+	return Hedron();
+}
+
+Hedron SubdivisionEngine::subdivide(const Hedron& mesh, QString* error, JobProgress* progress) const
+{
+	TRACE_SCOPE("subdivide");
+	int i;
+	int vrcholySize = mesh.getVrcholysize(), polohranySize = mesh.getHranysize(), stenySize = mesh.getStenysize();
+	for (i = 0; i < stenySize; i++) {
+		if (mesh.faceSize(i) != 3) {
+			if (error)
+				*error = QString("Stena %1 nie je trojuholnik.").arg(i);
+			return Hedron();
+		}
+	}
+	//vysledok ma 4x viac polohran a stien a najviac V + H vrcholov (stred kazdej hrany), vsetko musi vojst do int
+	if (qint64(4) * polohranySize > INT_MAX || qint64(vrcholySize) + polohranySize > INT_MAX) {
+		if (error)
+			*error = "Siet je na dalsie delenie prilis velka.";
+		return Hedron();
+	}
+
+	//pomocne polia delenia su v arene vlakna, po skonceni sa uvolnia naraz
+	ScratchArena& arena = ScratchArena::forThread();
+	ScratchArena::Scope scope(arena);
+	Trace::Stages stages("subdivide: count");
+
+	//polohrany bez paru s rovnakou neorientovanou hranou zdielaju stred prvej z nich (seriovo, na uzavretej sieti ziadne)
+	//polohrany bez paru sa hladaju v Twin, ulozene pocty nemusia zodpovedat (napr. siet nacitana z .hed)
+	const int* twin = mesh.arrayTwin().constData();
+	bool bezParovania = false;
+	for (i = 0; i < polohranySize && !bezParovania; i++)
+		bezParovania = twin[i] == -1;
+	int* alias = nullptr;
+	if (bezParovania) {
+		alias = arena.allocFilled(polohranySize, -1);
+		ArenaHash bezParu(arena, polohranySize);
+		for (i = 0; i < 3 * stenySize; i++) {
+			int h = edgeAt(mesh, i / 3, i % 3);
+			if (mesh.hasPair(h))
+				continue;
+			int a = mesh.origin(h), b = mesh.dest(h);
+			quint64 key = (quint64(quint32(qMin(a, b))) << 32) | quint32(qMax(a, b));
+			alias[h] = bezParu.insert(key, h);
+		}
+	}
+	const int* aliasData = alias;
+	auto vlastniStred = [&](int h) {
+		if (mesh.hasPair(h))
+			return edgeRank(mesh, h) < edgeRank(mesh, mesh.twin(h));
+		return aliasData[h] == h;
+	};
+
+	//1. pocet novych vrcholov v kazdom kuse stien, z toho posun indexov
+	int kusy = chunkCount(stenySize);
+	int* pocet = arena.allocFilled(kusy + 1, 0);
+	parallelFor(stenySize, [&](int t, int od, int po) {
+		int n = 0;
+		for (int f = od; f < po; f++)
+			for (int k = 0; k < 3; k++)
+				if (vlastniStred(edgeAt(mesh, f, k))) n++;
+		pocet[t + 1] = n;
+	});
+	for (i = 0; i < kusy; i++)
+		pocet[i + 1] += pocet[i];
+	int novySize = vrcholySize + pocet[kusy];
+	//priebeh sa hlasi po fazach, zrusenie sa kontroluje medzi nimi
+	if (jobCancelled(progress))
+		return cancelled(error);
+	jobProgress(progress, 1, 5);
+	stages.next("subdivide: midpoints");
+
+	Hedron delene;
+	delene.resize(novySize, 4 * polohranySize, 4 * stenySize);
+	int* stredData = arena.allocFilled(polohranySize, -1);
+
+	//2. stredy hran dostanu indexy v poradi stien, zapisuje ich len vlastnik hrany
+	parallelFor(stenySize, [&](int t, int od, int po) {
+		int v = vrcholySize + pocet[t];
+		for (int f = od; f < po; f++) {
+			for (int k = 0; k < 3; k++) {
+				int h = edgeAt(mesh, f, k);
+				if (!vlastniStred(h))
+					continue;
+				int a = mesh.origin(h), b = mesh.dest(h);
+				delene.setSur(v, (mesh.x(a) + mesh.x(b)) / 2.0, (mesh.y(a) + mesh.y(b)) / 2.0, (mesh.z(a) + mesh.z(b)) / 2.0);
+				stredData[h] = v;
+				if (mesh.hasPair(h))
+					stredData[mesh.twin(h)] = v;
+				v++;
+			}
+		}
+	});
+	if (aliasData) {
+		for (i = 0; i < polohranySize; i++)
+			if (!mesh.hasPair(i)) stredData[i] = stredData[aliasData[i]];
+	}
+	if (jobCancelled(progress))
+		return cancelled(error);
+	jobProgress(progress, 2, 5);
+	stages.next("subdivide: faces");
+
+	//3. stvorice stien a pary, kazda rodicovska stena zapisuje len svoje polohrany
+	parallelFor(stenySize, [&](int, int od, int po) {
+		int* twin = delene.arrayTwin().data();
+		for (int s = od; s < po; s++) {
+			int e[3] = { mesh.faceEdge(s), 0, 0 };
+			e[1] = mesh.next(e[0]);
+			e[2] = mesh.prev(e[0]);
+			int v[3] = { mesh.origin(e[0]), mesh.origin(e[1]), mesh.origin(e[2]) };
+			int A = stredData[e[0]], B = stredData[e[2]], C = stredData[e[1]];
+
+			int f = 4 * s, p = 12 * s;
+			int vrcholyStien[4][3] = { { v[0], A, B }, { A, v[1], C }, { B, C, v[2] }, { B, A, C } };
+			for (int k = 0; k < 4; k++) {
+				int h = p + 3 * k;
+				delene.setEdge(h, vrcholyStien[k][0], f + k, h + 2, h + 1);
+				delene.setEdge(h + 1, vrcholyStien[k][1], f + k, h, h + 2);
+				delene.setEdge(h + 2, vrcholyStien[k][2], f + k, h + 1, h);
+				delene.setFaceEdge(f + k, h);
+			}
+			//vnutorne pary
+			twin[p + 1] = p + 9;
+			twin[p + 9] = p + 1;
+			twin[p + 5] = p + 10;
+			twin[p + 10] = p + 5;
+			twin[p + 6] = p + 11;
+			twin[p + 11] = p + 6;
+			//vonkajsie pary: prva polovica parovej polohrany je parom druhej polovice tejto a naopak
+			for (int k = 0; k < 3; k++) {
+				int t = mesh.twin(e[k]);
+				if (t == -1)
+					continue;
+				int slot = edgeSlot(mesh, t), q = 12 * mesh.face(t);
+				twin[p + firstHalf[k]] = q + secondHalf[slot];
+				twin[p + secondHalf[k]] = q + firstHalf[slot];
+			}
+		}
+	});
+	if (jobCancelled(progress))
+		return cancelled(error);
+	jobProgress(progress, 3, 5);
+	stages.next("subdivide: project");
+
+	//4. projekcia na jednotkovu kruznicu
+	parallelFor(novySize, [&](int, int od, int po) {
+		for (int v = od; v < po; v++) {
+			double x = v < vrcholySize ? mesh.x(v) : delene.x(v);
+			double y = v < vrcholySize ? mesh.y(v) : delene.y(v);
+			double z = v < vrcholySize ? mesh.z(v) : delene.z(v);
+			double d = sqrt(x * x + y * y + z * z);
+			if ((1.0 - d) != 0)
+				delene.setSur(v, x / d, y / d, z / d);
+			else
+				delene.setSur(v, x, y, z);
+		}
+	});
+
+	jobProgress(progress, 4, 5);
+	stages.next("subdivide: vertex edges");
+
+	delene.updateVertexEdges();
+	delene.setUnpairedCounts(2 * mesh.getBoundaryCount(), 2 * mesh.getNonManifoldCount());
+	jobProgress(progress, 5, 5);
+	return delene;
+}
+
+Hedron subdivide(const Hedron& mesh, QString* error, JobProgress* progress)
+{
+	return SubdivisionEngine().subdivide(mesh, error, progress);
+}
+
+// mriezka jednej steny oktaedra: bod P(i, j) = (k * c0 + i * c1 + j * c2) / N, k = N - i - j
+// trojuholniky v riadku i: U(i, j) = P(i, j), P(i + 1, j), P(i, j + 1) a D(i, j) = P(i + 1, j), P(i + 1, j + 1), P(i, j + 1)
+class SphereGrid {
+	const Hedron& octa;
+	const int* hranaOkta;
+	int N, f;
+public:
+	SphereGrid(const Hedron& o, const int* hrany, int n, int stena) : octa(o) { hranaOkta = hrany; N = n; f = stena; };
+
+	int point(int i, int j) const { return i * (N + 1) - i * (i - 1) / 2 + j; };
+
+	// bod na strane m (0 = c0c1, 1 = c1c2, 2 = c2c0) vo vzdialenosti s od jej zaciatku
+	int sideVertex(int m, int s) const {
+		int h = 3 * f + m;
+		int d = octa.origin(h) < octa.dest(h) ? s : N - s;
+		return 6 + hranaOkta[h] * (N - 1) + d - 1;
+	};
+	int vertex(int i, int j) const {
+		int k = N - i - j;
+		if (i == 0 && j == 0) return octa.origin(3 * f);
+		if (i == N) return octa.origin(3 * f + 1);
+		if (j == N) return octa.origin(3 * f + 2);
+		if (j == 0) return sideVertex(0, i);
+		if (k == 0) return sideVertex(1, j);
+		if (i == 0) return sideVertex(2, N - j);
+		return 6 + 12 * (N - 1) + f * (N - 1) * (N - 2) / 2 + (i - 1) * (N - 1) - (i - 1) * i / 2 + j - 1;
+	};
+
+	int up(int i, int j) const { return 3 * (f * N * N + 2 * N * i - i * i + 2 * j); };
+	int down(int i, int j) const { return up(i, j) + 3; };
+	// polohrana na strane m, usek s od zaciatku strany
+	int side(int m, int s) const {
+		if (m == 0) return up(s, 0);
+		if (m == 1) return up(N - 1 - s, s) + 1;
+		return up(0, N - 1 - s) + 2;
+	};
+};
+
+Hedron geodesicSphere(int level, QString* error, JobProgress* progress)
+{
+	TRACE_SCOPE("geodesicSphere");
+	int i, j, s, m, f;
+	if (level < 0 || level > geodesicMaxLevel) {
+		if (error)
+			*error = QString("Uroven %1 je mimo rozsahu 0 - %2.").arg(level).arg(geodesicMaxLevel);
+		return Hedron();
+	}
+	Hedron octa = Hedron::octahedron();
+	if (level == 0)
+		return octa;
+	int N = 1 << level;
+	int vrcholySize = 4 * N * N + 2, stenySize = 8 * N * N;
+
+	//neorientovane hrany oktaedra
+	int hranaOkta[24], hranySize = 0;
+	for (i = 0; i < 24; i++) {
+		if (i < octa.twin(i))
+			hranaOkta[i] = hranaOkta[octa.twin(i)] = hranySize++;
+	}
+
+	Hedron sfera;
+	sfera.resize(vrcholySize, 3 * stenySize, stenySize);
+	int body = (N + 1) * (N + 2) / 2;
+	ScratchArena& arena = ScratchArena::forThread();
+	ScratchArena::Scope scope(arena);
+	double* gx = arena.alloc<double>(body);
+	double* gy = arena.alloc<double>(body);
+	double* gz = arena.alloc<double>(body);
+	for (f = 0; f < 8; f++) {
+		if (jobCancelled(progress))
+			return cancelled(error);
+		jobProgress(progress, f, 9);
+		SphereGrid grid(octa, hranaOkta, N, f);
+
+		//polohy sa pocitaju po urovniach ako pri opakovanom deleni: stred hrany predoslej urovne, potom projekcia vsetkych bodov
+		int c[3] = { grid.point(0, 0), grid.point(N, 0), grid.point(0, N) };
+		for (m = 0; m < 3; m++) {
+			int v = octa.origin(3 * f + m);
+			gx[c[m]] = octa.x(v);
+			gy[c[m]] = octa.y(v);
+			gz[c[m]] = octa.z(v);
+		}
+		for (s = N / 2; s >= 1; s /= 2) {
+			for (i = 0; i <= N; i += s) {
+				for (j = 0; j <= N - i; j += s) {
+					bool iOdd = (i / s) % 2 == 1, jOdd = (j / s) % 2 == 1;
+					if (!iOdd && !jOdd)
+						continue;
+					int a, b;
+					if (iOdd && jOdd) { a = grid.point(i + s, j - s); b = grid.point(i - s, j + s); }
+					else if (iOdd) { a = grid.point(i - s, j); b = grid.point(i + s, j); }
+					else { a = grid.point(i, j - s); b = grid.point(i, j + s); }
+					int p = grid.point(i, j);
+					gx[p] = (gx[a] + gx[b]) / 2.0;
+					gy[p] = (gy[a] + gy[b]) / 2.0;
+					gz[p] = (gz[a] + gz[b]) / 2.0;
+				}
+			}
+			//projekcia na jednotkovu kruznicu
+			for (i = 0; i <= N; i += s) {
+				for (j = 0; j <= N - i; j += s) {
+					int p = grid.point(i, j);
+					double d = sqrt(gx[p] * gx[p] + gy[p] * gy[p] + gz[p] * gz[p]);
+					if ((1.0 - d) != 0) {
+						gx[p] /= d;
+						gy[p] /= d;
+						gz[p] /= d;
+					}
+				}
+			}
+		}
+		for (i = 0; i <= N; i++) {
+			for (j = 0; j <= N - i; j++) {
+				int p = grid.point(i, j);
+				sfera.setSur(grid.vertex(i, j), gx[p], gy[p], gz[p]);
+			}
+		}
+
+		//steny a pary, na stranach sa pary hladaju v susednej stene oktaedra
+		for (i = 0; i < N; i++) {
+			for (j = 0; j < N - i; j++) {
+				int vrcholyStien[2][3] = { { grid.vertex(i, j), grid.vertex(i + 1, j), grid.vertex(i, j + 1) },
+					{ grid.vertex(i + 1, j), grid.vertex(i + 1, j + 1), grid.vertex(i, j + 1) } };
+				int pary[2][3] = {
+					{ j >= 1 ? grid.down(i, j - 1) + 1 : -1, i + j <= N - 2 ? grid.down(i, j) + 2 : -1, i >= 1 ? grid.down(i - 1, j) : -1 },
+					{ grid.up(i + 1, j) + 2, grid.up(i, j + 1), grid.up(i, j) + 1 } };
+				for (int t = 0; t < (i + j <= N - 2 ? 2 : 1); t++) {
+					int h = t == 0 ? grid.up(i, j) : grid.down(i, j);
+					for (m = 0; m < 3; m++)
+						sfera.setEdge(h + m, vrcholyStien[t][m], h / 3, h + (m + 2) % 3, h + (m + 1) % 3, pary[t][m]);
+					sfera.setFaceEdge(h / 3, h);
+				}
+			}
+		}
+		for (m = 0; m < 3; m++) {
+			int t = octa.twin(3 * f + m);
+			SphereGrid sused(octa, hranaOkta, N, t / 3);
+			for (s = 0; s < N; s++)
+				sfera.arrayTwin()[grid.side(m, s)] = sused.side(t % 3, N - 1 - s);
+		}
+	}
+
+	sfera.updateVertexEdges();
+	jobProgress(progress, 9, 9);
+	return sfera;
+}
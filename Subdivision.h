@@ -0,0 +1,30 @@
+#pragma once
+#include <QtCore>
+#include "Objekt.h"
+#include "Job.h"
+
+// delenie kazdeho trojuholnika na 4 so stredmi hran premietnutymi na jednotkovu sferu
+// stred kazdej hrany vznikne prave raz, pary polohran sa odvodia z rodicovskych bez hashovania
+// poradie vrcholov a stien nezavisi od poctu vlakien, vysledok je rovnaky ako pri jednom vlakne
+class SubdivisionEngine {
+	int threadCount;
+
+	int chunkCount(int n) const;
+	template <typename F> void parallelFor(int n, F f) const;
+public:
+	SubdivisionEngine(int threads = QThread::idealThreadCount()) { setThreadCount(threads); };
+	void setThreadCount(int threads) { threadCount = qMax(1, threads); };
+	int getThreadCount() const { return threadCount; };
+
+	// pri chybe (stena nie je trojuholnik) alebo zruseni ulohy vrati prazdny Hedron
+	Hedron subdivide(const Hedron& mesh, QString* error = nullptr, JobProgress* progress = nullptr) const;
+};
+
+Hedron subdivide(const Hedron& mesh, QString* error = nullptr, JobProgress* progress = nullptr);
+
+// geodeticka sfera z oktaedra na urovni level (0 = oktaeder) v jednom kroku, bez medzivysledkov
+// V = 4^level * 4 + 2, F = 8 * 4^level, polia sa alokuju raz v presnej velkosti
+// polohy vrcholov su rovnake ako po level-nasobnom subdivide, poradie vrcholov a stien je ine
+// level mimo 0 - geodesicMaxLevel (pocet polohran by pretiekol int) vrati prazdny Hedron s chybou
+static const int geodesicMaxLevel = 13;
+Hedron geodesicSphere(int level, QString* error = nullptr, JobProgress* progress = nullptr);
@@ -0,0 +1,209 @@
+#include "Trace.h"
+#include <chrono>
+
+namespace {
+	struct Event {
+		const char* name;
+		qint64 ts;
+		qint64 value;		// trvanie alebo hodnota pocitadla
+		bool isCounter;
+	};
+
+	// kruhovy buffer jedneho vlakna, zapisuje len vlastnik, citatel vidi udalosti po count (release / acquire)
+	struct ThreadBuffer {
+		static const int chunkSize = 4096;
+		static const int chunks = 64;
+		static const qint64 capacity = qint64(chunkSize) * chunks;
+		int tid = 0;
+		std::atomic<Event*> chunk[chunks];
+		std::atomic<qint64> count{ 0 };
+		ThreadBuffer() { for (auto& c : chunk) c.store(nullptr, std::memory_order_relaxed); };
+	};
+
+	// bufre sa neuvolnuju, export ich cita aj po skonceni vlakna; buffer skonceneho vlakna prevezme
+	// dalsie nove vlakno (vlakna QThreadPool po necinnosti zanikaju a vznikaju znovu), bufrov je
+	// preto najviac tolko, kolko vlakien naraz zapisovalo
+	QMutex registryMutex;
+	QVector<ThreadBuffer*> registry;
+	QVector<ThreadBuffer*> freeBuffers;
+	QHash<QString, const char*> names;
+	std::atomic<qint64> startTime{ 0 };
+
+	// vrati buffer do freeBuffers pri skonceni vlakna, jeho udalosti v nom zostavaju
+	struct LocalBuffer {
+		ThreadBuffer* buffer = nullptr;
+		~LocalBuffer() {
+			if (!buffer)
+				return;
+			QMutexLocker lock(&registryMutex);
+			freeBuffers.append(buffer);
+		}
+	};
+	thread_local LocalBuffer local;
+
+	ThreadBuffer* registerThread()
+	{
+		QMutexLocker lock(&registryMutex);
+		if (!freeBuffers.isEmpty()) {
+			local.buffer = freeBuffers.takeLast();
+			return local.buffer;
+		}
+		local.buffer = new ThreadBuffer;
+		local.buffer->tid = registry.size() + 1;
+		registry.append(local.buffer);
+		return local.buffer;
+	}
+
+	void record(const char* name, qint64 ts, qint64 value, bool isCounter)
+	{
+		ThreadBuffer* b = local.buffer ? local.buffer : registerThread();
+		qint64 n = b->count.load(std::memory_order_relaxed);
+		int c = int((n / ThreadBuffer::chunkSize) % ThreadBuffer::chunks);
+		Event* chunk = b->chunk[c].load(std::memory_order_relaxed);
+		if (!chunk) {
+			chunk = new Event[ThreadBuffer::chunkSize];
+			b->chunk[c].store(chunk, std::memory_order_relaxed);
+		}
+		chunk[n % ThreadBuffer::chunkSize] = Event{ name, ts, value, isCounter };
+		b->count.store(n + 1, std::memory_order_release);
+	}
+
+	const Event& at(const ThreadBuffer* b, qint64 i)
+	{
+		return b->chunk[(i / ThreadBuffer::chunkSize) % ThreadBuffer::chunks].load(std::memory_order_relaxed)[i % ThreadBuffer::chunkSize];
+	}
+
+	// koniec udalosti, v bufri vlakna rastie (udalost s trvanim sa zapisuje az na jej konci)
+	qint64 eventEnd(const Event& e)
+	{
+		return e.isCounter ? e.ts : e.ts + e.value;
+	}
+
+	// udalosti vlakna skoncene od casu since, bez tych, ktore mohol vlastnik pocas kopirovania prepisat
+	QVector<Event> collect(const ThreadBuffer* b, qint64 since)
+	{
+		qint64 n = b->count.load(std::memory_order_acquire);
+		qint64 from = qMax(qint64(0), n - ThreadBuffer::capacity);
+		qint64 i = n;
+		while (i > from && eventEnd(at(b, i - 1)) >= since)
+			i--;
+		QVector<Event> out;
+		out.reserve(int(n - i));
+		for (qint64 k = i; k < n; k++)
+			out.append(at(b, k));
+		qint64 platne = b->count.load(std::memory_order_acquire) + 1 - ThreadBuffer::capacity;
+		if (platne > i)
+			out.remove(0, int(qMin(platne - i, qint64(out.size()))));
+		return out;
+	}
+
+	QVector<ThreadBuffer*> buffers()
+	{
+		QMutexLocker lock(&registryMutex);
+		return registry;
+	}
+
+	void appendJsonString(QByteArray& out, const char* text)
+	{
+		out.append('"');
+		for (const char* p = text; *p; p++) {
+			if (*p == '"' || *p == '\\')
+				out.append('\\');
+			if (uchar(*p) >= 0x20)
+				out.append(*p);
+		}
+		out.append('"');
+	}
+}
+
+namespace Trace {
+	std::atomic<bool> enabled{ false };
+
+	qint64 now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void setEnabled(bool on)
+	{
+		if (on && !isEnabled())
+			startTime.store(now());
+		enabled.store(on);
+	}
+
+	const char* name(const QString& text)
+	{
+		QMutexLocker lock(&registryMutex);
+		const char*& n = names[text];
+		if (!n)
+			n = qstrdup(text.toUtf8().constData());
+		return n;
+	}
+
+	void complete(const char* name, qint64 begin, qint64 end)
+	{
+		record(name, begin, end - begin, false);
+	}
+
+	void counter(const char* name, qint64 value)
+	{
+		if (isEnabled())
+			record(name, now(), value, true);
+	}
+
+	QHash<QString, Stat> summary(qint64 since)
+	{
+		QHash<QString, Stat> stats;
+		since = qMax(since, startTime.load());
+		for (ThreadBuffer* b : buffers()) {
+			for (const Event& e : collect(b, since)) {
+				Stat& s = stats[QString::fromUtf8(e.name)];
+				s.count++;
+				if (e.isCounter) {
+					s.last = e.value;
+				}
+				else {
+					s.total += e.value;
+					s.max = qMax(s.max, e.value);
+				}
+			}
+		}
+		return stats;
+	}
+
+	bool exportChrome(QString fileName, QString* error)
+	{
+		qint64 start = startTime.load();
+		QByteArray out = "{\"traceEvents\":[\n";
+		bool prva = true;
+		for (ThreadBuffer* b : buffers()) {
+			QVector<Event> events = collect(b, start);
+			if (events.isEmpty())
+				continue;
+			out.append(prva ? "" : ",\n");
+			prva = false;
+			out.append(QString("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%1,\"args\":{\"name\":\"thread %1\"}}").arg(b->tid).toUtf8());
+			for (const Event& e : events) {
+				out.append(",\n{\"name\":");
+				appendJsonString(out, e.name);
+				QByteArray ts = QByteArray::number((e.ts - start) / 1000.0, 'f', 3);
+				if (e.isCounter)
+					out.append(",\"ph\":\"C\",\"ts\":" + ts + ",\"pid\":1,\"tid\":" + QByteArray::number(b->tid) + ",\"args\":{\"value\":" + QByteArray::number(e.value) + "}}");
+				else
+					out.append(",\"ph\":\"X\",\"ts\":" + ts + ",\"dur\":" + QByteArray::number(e.value / 1000.0, 'f', 3) + ",\"pid\":1,\"tid\":" + QByteArray::number(b->tid) + "}");
+			}
+		}
+		out.append("\n],\"displayTimeUnit\":\"ms\"}\n");
+
+		QFile file(fileName);
+		if (!file.open(QIODevice::WriteOnly)) {
+			if (error) *error = "Unable to open file.";
+			return false;
+		}
+		if (file.write(out) != out.size()) {
+			if (error) *error = "Zapis do suboru zlyhal.";
+			return false;
+		}
+		return true;
+	}
+}
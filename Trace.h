@@ -0,0 +1,67 @@
+#pragma once
+#include <QtCore>
+#include <atomic>
+
+// meranie casov a pocitadiel v horucich cestach (udalosti, kreslenie, operacie nad sietou)
+// vypnute stoji jedno citanie atomickej premennej, zapnute zapisuje kazde vlakno do vlastneho kruhoveho bufra bez zamku
+// zaznam sa exportuje ako Chrome trace JSON (chrome://tracing, Perfetto)
+// nazvy udalosti musia zit do konca programu (retazcove literaly alebo Trace::name)
+namespace Trace {
+	extern std::atomic<bool> enabled;
+
+	inline bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+	// zapnutie zacne novy zaznam, starsie udalosti sa do exportu nedostanu
+	void setEnabled(bool on);
+	// cas v ns od spustenia programu
+	qint64 now();
+	// trvalo zachovany nazov pre dynamicky text (nazov ulohy), pomale, nie na horucu cestu
+	const char* name(const QString& text);
+
+	// udalost s trvanim od begin po end (ns)
+	void complete(const char* name, qint64 begin, qint64 end);
+	// hodnota pocitadla v tomto case
+	void counter(const char* name, qint64 value);
+
+	// trvanie bloku: Trace::Scope scope("paint"); alebo TRACE_SCOPE("paint")
+	class Scope {
+		const char* label;
+		qint64 begin;
+	public:
+		explicit Scope(const char* name) : label(isEnabled() ? name : nullptr), begin(label ? now() : 0) {};
+		~Scope() { if (label) complete(label, begin, now()); };
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+
+	// po sebe iduce faze jednej operacie: Stages s("subdivide: count"); ... s.next("subdivide: faces");
+	class Stages {
+		const char* label;
+		qint64 begin;
+	public:
+		explicit Stages(const char* first) : label(isEnabled() ? first : nullptr), begin(label ? now() : 0) {};
+		~Stages() { if (label) complete(label, begin, now()); };
+		void next(const char* name) {
+			if (!label) return;
+			qint64 t = now();
+			complete(label, begin, t);
+			label = name;
+			begin = t;
+		};
+		Stages(const Stages&) = delete;
+		Stages& operator=(const Stages&) = delete;
+	};
+
+	// suhrn udalosti od casu since pre zobrazenie v statusBar
+	struct Stat {
+		int count = 0;
+		qint64 total = 0, max = 0;	// trvanie (ns)
+		qint64 last = 0;			// posledna hodnota pocitadla
+	};
+	QHash<QString, Stat> summary(qint64 since);
+
+	bool exportChrome(QString fileName, QString* error = nullptr);
+}
+
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
@@ -0,0 +1,203 @@
+#include "Transform.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRANSFORM_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// AVX2 jadro sa prelozi aj bez -mavx2, spusti sa len ked ho procesor podporuje
+#if defined(TRANSFORM_X86) && defined(__GNUC__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+// parametre spolocne pre vsetky jadra, poradie operacii je vsade rovnake
+struct Viewport {
+	float halfWidth, halfHeight;
+};
+
+static void transformScalar(const double* x, const double* y, const double* z, int od, int po, const float* m, Viewport vp, ScreenVertices& out)
+{
+	float* sx = out.x.data();
+	float* sy = out.y.data();
+	float* sz = out.z.data();
+	uchar* clip = out.clip.data();
+	for (int i = od; i < po; i++) {
+		float px = float(x[i]), py = float(y[i]), pz = float(z[i]);
+		float cx = m[0] * px + m[4] * py + m[8] * pz + m[12];
+		float cy = m[1] * px + m[5] * py + m[9] * pz + m[13];
+		float cz = m[2] * px + m[6] * py + m[10] * pz + m[14];
+		float cw = m[3] * px + m[7] * py + m[11] * pz + m[15];
+		float minusW = -cw;
+		clip[i] = uchar((cx < minusW ? ClipLeft : 0) | (cx > cw ? ClipRight : 0) | (cy < minusW ? ClipBottom : 0) | (cy > cw ? ClipTop : 0)
+			| (cz < minusW ? ClipNear : 0) | (cz > cw ? ClipFar : 0));
+		float iw = 1.0f / cw;
+		sx[i] = cx * iw * vp.halfWidth + vp.halfWidth;
+		sy[i] = vp.halfHeight - cy * iw * vp.halfHeight;
+		sz[i] = cz * iw;
+	}
+}
+
+#ifdef TRANSFORM_X86
+static int transformSse(const double* x, const double* y, const double* z, int n, const float* m, Viewport vp, ScreenVertices& out)
+{
+	float* sx = out.x.data();
+	float* sy = out.y.data();
+	float* sz = out.z.data();
+	uchar* clip = out.clip.data();
+	__m128 r[16];
+	for (int k = 0; k < 16; k++)
+		r[k] = _mm_set1_ps(m[k]);
+	__m128 one = _mm_set1_ps(1.0f), hw = _mm_set1_ps(vp.halfWidth), hh = _mm_set1_ps(vp.halfHeight);
+	__m128 sign = _mm_set1_ps(-0.0f);
+	int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128 px = _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(x + i)), _mm_cvtpd_ps(_mm_loadu_pd(x + i + 2)));
+		__m128 py = _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(y + i)), _mm_cvtpd_ps(_mm_loadu_pd(y + i + 2)));
+		__m128 pz = _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(z + i)), _mm_cvtpd_ps(_mm_loadu_pd(z + i + 2)));
+		__m128 cx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r[0], px), _mm_mul_ps(r[4], py)), _mm_mul_ps(r[8], pz)), r[12]);
+		__m128 cy = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r[1], px), _mm_mul_ps(r[5], py)), _mm_mul_ps(r[9], pz)), r[13]);
+		__m128 cz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r[2], px), _mm_mul_ps(r[6], py)), _mm_mul_ps(r[10], pz)), r[14]);
+		__m128 cw = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r[3], px), _mm_mul_ps(r[7], py)), _mm_mul_ps(r[11], pz)), r[15]);
+		__m128 minusW = _mm_xor_ps(cw, sign);
+		int masky[6] = { _mm_movemask_ps(_mm_cmplt_ps(cx, minusW)), _mm_movemask_ps(_mm_cmpgt_ps(cx, cw)), _mm_movemask_ps(_mm_cmplt_ps(cy, minusW)),
+			_mm_movemask_ps(_mm_cmpgt_ps(cy, cw)), _mm_movemask_ps(_mm_cmplt_ps(cz, minusW)), _mm_movemask_ps(_mm_cmpgt_ps(cz, cw)) };
+		for (int l = 0; l < 4; l++) {
+			int f = 0;
+			for (int k = 0; k < 6; k++)
+				f |= ((masky[k] >> l) & 1) << k;
+			clip[i + l] = uchar(f);
+		}
+		__m128 iw = _mm_div_ps(one, cw);
+		_mm_storeu_ps(sx + i, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(cx, iw), hw), hw));
+		_mm_storeu_ps(sy + i, _mm_sub_ps(hh, _mm_mul_ps(_mm_mul_ps(cy, iw), hh)));
+		_mm_storeu_ps(sz + i, _mm_mul_ps(cz, iw));
+	}
+	return i;
+}
+
+TARGET_AVX2 static __m256 loadAvx2(const double* p)
+{
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(_mm256_loadu_pd(p))), _mm256_cvtpd_ps(_mm256_loadu_pd(p + 4)), 1);
+}
+
+TARGET_AVX2 static int transformAvx2(const double* x, const double* y, const double* z, int n, const float* m, Viewport vp, ScreenVertices& out)
+{
+	float* sx = out.x.data();
+	float* sy = out.y.data();
+	float* sz = out.z.data();
+	uchar* clip = out.clip.data();
+	__m256 r[16];
+	for (int k = 0; k < 16; k++)
+		r[k] = _mm256_set1_ps(m[k]);
+	__m256 one = _mm256_set1_ps(1.0f), hw = _mm256_set1_ps(vp.halfWidth), hh = _mm256_set1_ps(vp.halfHeight);
+	__m256 sign = _mm256_set1_ps(-0.0f);
+	//priznaky sa skladaju v 32-bitovych drahach a nakoniec zuzia na bajty
+	__m256i bity[6];
+	for (int k = 0; k < 6; k++)
+		bity[k] = _mm256_set1_epi32(1 << k);
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256 px = loadAvx2(x + i), py = loadAvx2(y + i), pz = loadAvx2(z + i);
+		__m256 cx = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[0], px), _mm256_mul_ps(r[4], py)), _mm256_mul_ps(r[8], pz)), r[12]);
+		__m256 cy = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[1], px), _mm256_mul_ps(r[5], py)), _mm256_mul_ps(r[9], pz)), r[13]);
+		__m256 cz = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[2], px), _mm256_mul_ps(r[6], py)), _mm256_mul_ps(r[10], pz)), r[14]);
+		__m256 cw = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[3], px), _mm256_mul_ps(r[7], py)), _mm256_mul_ps(r[11], pz)), r[15]);
+		__m256 minusW = _mm256_xor_ps(cw, sign);
+		__m256 masky[6] = { _mm256_cmp_ps(cx, minusW, _CMP_LT_OQ), _mm256_cmp_ps(cx, cw, _CMP_GT_OQ), _mm256_cmp_ps(cy, minusW, _CMP_LT_OQ),
+			_mm256_cmp_ps(cy, cw, _CMP_GT_OQ), _mm256_cmp_ps(cz, minusW, _CMP_LT_OQ), _mm256_cmp_ps(cz, cw, _CMP_GT_OQ) };
+		__m256i f = _mm256_setzero_si256();
+		for (int k = 0; k < 6; k++)
+			f = _mm256_or_si256(f, _mm256_and_si256(_mm256_castps_si256(masky[k]), bity[k]));
+		__m128i f16 = _mm_packs_epi32(_mm256_castsi256_si128(f), _mm256_extracti128_si256(f, 1));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(clip + i), _mm_packus_epi16(f16, f16));
+		__m256 iw = _mm256_div_ps(one, cw);
+		_mm256_storeu_ps(sx + i, _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(cx, iw), hw), hw));
+		_mm256_storeu_ps(sy + i, _mm256_sub_ps(hh, _mm256_mul_ps(_mm256_mul_ps(cy, iw), hh)));
+		_mm256_storeu_ps(sz + i, _mm256_mul_ps(cz, iw));
+	}
+	return i;
+}
+
+static bool cpuHasAvx2()
+{
+	int leaf1[4], leaf7[4];
+#if defined(_MSC_VER)
+	__cpuid(leaf1, 1);
+	__cpuidex(leaf7, 7, 0);
+#else
+	if (__get_cpuid_max(0, nullptr) < 7)
+		return false;
+	__cpuid(1, leaf1[0], leaf1[1], leaf1[2], leaf1[3]);
+	__cpuid_count(7, 0, leaf7[0], leaf7[1], leaf7[2], leaf7[3]);
+#endif
+	//AVX2 musi podporovat procesor (leaf 7 ebx) aj system, ktory uklada YMM registre (OSXSAVE + XCR0)
+	bool osxsave = (leaf1[2] & (1 << 27)) != 0, avx = (leaf1[2] & (1 << 28)) != 0, avx2 = (leaf7[1] & (1 << 5)) != 0;
+	if (!osxsave || !avx || !avx2)
+		return false;
+#if defined(_MSC_VER)
+	unsigned long long xcr0 = _xgetbv(0);
+#else
+	unsigned int eax, edx;
+	__asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	unsigned long long xcr0 = (quint64(edx) << 32) | eax;
+#endif
+	return (xcr0 & 6) == 6;
+}
+#endif
+
+bool isTransformKernelSupported(TransformKernel kernel)
+{
+#ifdef TRANSFORM_X86
+	static const bool avx2 = cpuHasAvx2();
+	return kernel != Avx2Kernel || avx2;
+#else
+	return kernel == ScalarKernel;
+#endif
+}
+
+TransformKernel bestTransformKernel()
+{
+	if (isTransformKernelSupported(Avx2Kernel))
+		return Avx2Kernel;
+	if (isTransformKernelSupported(SseKernel))
+		return SseKernel;
+	return ScalarKernel;
+}
+
+const char* transformKernelName(TransformKernel kernel)
+{
+	switch (kernel) {
+	case Avx2Kernel: return "avx2";
+	case SseKernel: return "sse";
+	default: return "scalar";
+	}
+}
+
+void transformVertices(const double* x, const double* y, const double* z, int n, const float* mvp, int width, int height,
+	ScreenVertices& out, TransformKernel kernel)
+{
+	out.x.resize(n);
+	out.y.resize(n);
+	out.z.resize(n);
+	out.clip.resize(n);
+	Viewport vp = { 0.5f * width, 0.5f * height };
+	if (!isTransformKernelSupported(kernel))
+		kernel = bestTransformKernel();
+
+	//SIMD jadro spracuje cele bloky, zvysok pole dopocita skalarne
+	int hotovo = 0;
+#ifdef TRANSFORM_X86
+	if (kernel == Avx2Kernel)
+		hotovo = transformAvx2(x, y, z, n, mvp, vp, out);
+	else if (kernel == SseKernel)
+		hotovo = transformSse(x, y, z, n, mvp, vp, out);
+#endif
+	transformScalar(x, y, z, hotovo, n, mvp, vp, out);
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <QtCore>
+
+// priznaky orezania vrcholu v clip priestore (mimo pohladoveho telesa)
+enum ClipFlag { ClipLeft = 1, ClipRight = 2, ClipBottom = 4, ClipTop = 8, ClipNear = 16, ClipFar = 32 };
+
+// vrcholy po projekcii: obrazovkove x, y (y nadol), hlbka z v NDC a priznaky orezania
+// pri ClipNear su x, y, z neplatne
+struct ScreenVertices {
+	QVector<float> x, y, z;
+	QVector<uchar> clip;
+};
+
+// jadra transformacie, Avx2 a Sse len na x86, ktore z nich procesor zvladne sa zisti za behu
+enum TransformKernel { ScalarKernel, SseKernel, Avx2Kernel };
+TransformKernel bestTransformKernel();
+bool isTransformKernelSupported(TransformKernel kernel);
+const char* transformKernelName(TransformKernel kernel);
+
+// vrcholy (x[i], y[i], z[i], 1) * mvp (4x4 po stlpcoch ako QMatrix4x4::constData) a premietnutie do okna width x height
+// vsetky jadra pocitaju v rovnakom poradi operacii, bez FMA kontrakcie su vysledky bitovo rovnake
+void transformVertices(const double* x, const double* y, const double* z, int n, const float* mvp, int width, int height,
+	ScreenVertices& out, TransformKernel kernel = bestTransformKernel());
@@ -1,4 +1,5 @@
 #include   "ViewerWidget.h"
+#include <QtConcurrent>
 
 ViewerWidget::ViewerWidget(QString viewerName, QSize imgSize, QWidget* parent)
 	: QWidget(parent)
@@ -6,17 +7,16 @@ ViewerWidget::ViewerWidget(QString viewerName, QSize imgSize, QWidget* parent)
 	setAttribute(Qt::WA_StaticContents);
 	setMouseTracking(true);
 	name = viewerName;
+	connect(&pyramidWatcher, &QFutureWatcher<QVector<MipPyramid::Level>>::finished, this, &ViewerWidget::pyramidBuilt);
+	connect(&historyWatcher, &QFutureWatcher<CanvasHistory::PackResult>::finished, this, &ViewerWidget::historyPacked);
 	if (imgSize != QSize(0, 0)) {
-		img = new QImage(imgSize, QImage::Format_ARGB32);
-		img->fill(Qt::white);
-		resizeWidget(img->size());
-		setPainter();
+		canvas.reset(imgSize, qRgb(255, 255, 255));
+		pyramid.reset(imgSize);
+		resizeWidget(canvas.getSize());
 	}
 }
 ViewerWidget::~ViewerWidget()
 {
-	delete painter;
-	delete img;
 }
 void ViewerWidget::resizeWidget(QSize size)
 {
@@ -26,24 +26,44 @@ void ViewerWidget::resizeWidget(QSize size)
 }
 
 //Image functions
-bool ViewerWidget::setImage(const QImage& inputImg)
+bool ViewerWidget::setImage(QImage inputImg)
 {
-	if (img != nullptr) {
-		delete img;
+	if (inputImg.isNull()) {
+		return false;
 	}
-	img = new QImage(inputImg);
-	if (!img) {
+	//obrazok sa neskopiruje, dlazdice sa z neho kopiruju az pri kresleni
+	return setSource(QSharedPointer<const ImageSource>(new DecodedImageSource(std::move(inputImg))));
+}
+bool ViewerWidget::setSource(QSharedPointer<const ImageSource> source)
+{
+	pendingStroke.clear();
+	pendingRect = QRect();
+	if (!source || source->size().isEmpty()) {
 		return false;
 	}
-	resizeWidget(img->size());
-	setPainter();
+	canvas.reset(source->size(), qRgb(255, 255, 255), source);
+	history.clear();
+	pyramid.reset(canvas.getSize());
+	zoomStep = 0;
+	resizeWidget(canvas.getSize());
 	update();
 
 	return true;
 }
+bool ViewerWidget::replaceSource(QSharedPointer<const ImageSource> source)
+{
+	QSharedPointer<const ImageSource> old = canvas.getSource();
+	if (!canvas.setSource(source)) {
+		return false;
+	}
+	history.replaceSource(old, source);
+	pyramid.invalidateAll();
+	update();
+	return true;
+}
 bool ViewerWidget::isEmpty()
 {
-	if (img->size() == QSize(0, 0)) {
+	if (canvas.isEmpty()) {
 		return true;
 	}
 	return false;
@@ -52,22 +72,197 @@ bool ViewerWidget::isEmpty()
 //Draw functions
 void ViewerWidget::freeDraw(QPoint end, QPen pen)
 {
-	painter->setPen(pen);
-	painter->drawLine(freeDrawBegin, end);
+	//usek nadvazuje na rozkreslenu ciaru, inak sa ta najprv dokresli
+	if (!pendingStroke.isEmpty() && (pendingStroke.last() != freeDrawBegin || pen != pendingPen))
+		flushStrokes();
+	if (pendingStroke.isEmpty()) {
+		pendingStroke.append(freeDrawBegin);
+		pendingPen = pen;
+	}
+	pendingStroke.append(end);
+
+	//obdlznik useku zvacseny o hrubku pera (a antialiasing)
+	int okraj = qCeil(qMax(pen.widthF(), 1.0) / 2.0) + 2;
+	QRect usek = QRect(freeDrawBegin, end).normalized().adjusted(-okraj, -okraj, okraj, okraj);
+	pendingRect = pendingRect.united(usek);
+	update(mapFromImage(usek));
+}
+
+void ViewerWidget::flushStrokes()
+{
+	if (pendingStroke.isEmpty())
+		return;
+	TRACE_SCOPE("flushStrokes");
+	//ciara sa nakresli do kazdej dlazdice, ktorej sa dotyka, povodne dlazdice si odlozi zaznam pre historiu
+	if (!canvas.isRecording())
+		canvas.beginRecord();
+	canvas.paint(pendingRect, [this](QPainter& painter) {
+		painter.setPen(pendingPen);
+		painter.drawPolyline(pendingStroke);
+	});
+	pyramid.invalidate(pendingRect);
+	pendingStroke.clear();
+	pendingRect = QRect();
+}
 
+void ViewerWidget::setFreeDrawActivated(bool state)
+{
+	if (freeDrawActivated && !state) {
+		flushStrokes();
+		commitEdit();
+	}
+	freeDrawActivated = state;
+}
+
+void ViewerWidget::write(const QImage& src, QPoint at)
+{
+	//zapis celych snimok sa do historie nezaznamenava, predosle kroky by uz nesedeli
+	flushStrokes();
+	commitEdit();
+	history.clear();
+	canvas.write(src, at);
+	pyramid.invalidate(QRect(at, src.size()));
 	update();
 }
 
 void ViewerWidget::clear()
 {
-	img->fill(Qt::white);
+	flushStrokes();
+	commitEdit();
+	//clear si pamata uvolnene dlazdice (bez kopirovania) aj povodny zdroj
+	canvas.beginRecord();
+	canvas.clear(qRgb(255, 255, 255));
+	commitEdit();
+	pyramid.reset(canvas.getSize());
+	update();
+}
+
+//Undo functions
+void ViewerWidget::commitEdit()
+{
+	if (!canvas.isRecording())
+		return;
+	history.push(canvas, canvas.endRecord());
+	packHistory();
+}
+
+void ViewerWidget::packHistory()
+{
+	//naraz sa bali jeden krok, po dokonceni sa vyziada dalsi
+	if (historyPacking)
+		return;
+	CanvasHistory::PackJob job;
+	if (!history.takePackJob(job))
+		return;
+	historyPacking = true;
+	historyWatcher.setFuture(QtConcurrent::run(&CanvasHistory::pack, job));
+}
+
+void ViewerWidget::historyPacked()
+{
+	historyPacking = false;
+	history.packed(historyWatcher.result());
+	packHistory();
+}
+
+bool ViewerWidget::undo()
+{
+	flushStrokes();
+	commitEdit();
+	QRect area;
+	bool background;
+	if (!history.undo(canvas, &area, &background))
+		return false;
+	restored(area, background);
+	return true;
+}
+
+bool ViewerWidget::redo()
+{
+	flushStrokes();
+	commitEdit();
+	QRect area;
+	bool background;
+	if (!history.redo(canvas, &area, &background))
+		return false;
+	restored(area, background);
+	return true;
+}
+
+void ViewerWidget::restored(QRect area, bool background)
+{
+	if (background) {
+		pyramid.invalidateAll();
+		update();
+		return;
+	}
+	pyramid.invalidate(area);
+	update(mapFromImage(area));
+}
+
+//Zoom functions
+void ViewerWidget::setZoomStep(int step)
+{
+	//oddialit sa da po najhrubsiu uroven pyramidy, priblizit 8x
+	zoomStep = qBound(-2 * pyramid.getLevels() - 1, step, 6);
+	qreal zoom = getZoom();
+	resizeWidget(QSize(qCeil(canvas.width() * zoom), qCeil(canvas.height() * zoom)));
+	update();
+}
+QPoint ViewerWidget::mapToImage(QPoint p)
+{
+	qreal zoom = getZoom();
+	return QPoint(qFloor(p.x() / zoom), qFloor(p.y() / zoom));
+}
+QRect ViewerWidget::mapFromImage(QRect r)
+{
+	qreal zoom = getZoom();
+	return QRect(QPoint(qFloor(r.left() * zoom), qFloor(r.top() * zoom)), QPoint(qCeil((r.right() + 1) * zoom), qCeil((r.bottom() + 1) * zoom)));
+}
+
+void ViewerWidget::buildPyramid(int level, QVector<int> tiles)
+{
+	//naraz bezi jeden vypocet, po jeho skonceni sa widget prekresli a vyziada zvysne dlazdice
+	if (pyramidBuilding)
+		return;
+	pyramidBuilding = true;
+	pyramidWatcher.setFuture(QtConcurrent::run(&MipPyramid::build, canvas, pyramid.snapshot(), level, tiles));
+}
+
+void ViewerWidget::pyramidBuilt()
+{
+	pyramidBuilding = false;
+	pyramid.merge(pyramidWatcher.result());
 	update();
 }
 
 //Slots
 void ViewerWidget::paintEvent(QPaintEvent* event)
 {
+	TRACE_SCOPE("paint");
+	if (inputTime >= 0) {
+		Trace::complete("input to paint", inputTime, Trace::now());
+		inputTime = -1;
+	}
+	flushStrokes();
 	QPainter painter(this);
-	QRect area = event->rect();
-	painter.drawImage(area, *img, area);
+	if (zoomStep == 0) {
+		canvas.draw(painter, event->rect());
+		return;
+	}
+
+	//uroven pyramidy s rozlisenim aspon takym ako na obrazovke, zmensuje sa z nej najviac na polovicu
+	int level = zoomStep < 0 ? qMin(-zoomStep / 2, pyramid.getLevels()) : 0;
+	qreal s = getZoom() * (1 << level);
+	painter.setRenderHint(QPainter::SmoothPixmapTransform, zoomStep < 0);
+	painter.scale(s, s);
+	QRect area = QRectF(event->rect().x() / s, event->rect().y() / s, event->rect().width() / s, event->rect().height() / s).toAlignedRect();
+	if (level == 0) {
+		canvas.draw(painter, area);
+		return;
+	}
+	QVector<int> missing;
+	pyramid.draw(painter, level, area, canvas.getFillColor(), missing);
+	if (!missing.isEmpty())
+		buildPyramid(level, missing);
 }
\ No newline at end of file
@@ -1,44 +1,104 @@
 #pragma once
 #include <QtWidgets>
+#include "Canvas.h"
+#include "Pyramid.h"
+#include "History.h"
+#include "Trace.h"
 class ViewerWidget :public QWidget {
 	Q_OBJECT
 private:
 	QString name = "";
 	QSize areaSize = QSize(0, 0);
-	QImage* img = nullptr;
-	QPainter* painter = nullptr;
+	//obrazok po dlazdiciach, pamat sa alokuje az pri kresleni
+	TiledCanvas canvas;
+
+	//priblizenie 2^(zoomStep / 2), pri oddialeni sa kresli z pyramidy, ktorej dlazdice sa pocitaju v pozadi
+	int zoomStep = 0;
+	MipPyramid pyramid;
+	QFutureWatcher<QVector<MipPyramid::Level>> pyramidWatcher;
+	bool pyramidBuilding = false;
+	void buildPyramid(int level, QVector<int> tiles);
+
+	//historia kreslenia po dlazdiciach, krok je jeden tah mysou alebo clear, kroky sa balia v pozadi
+	CanvasHistory history;
+	QFutureWatcher<CanvasHistory::PackResult> historyWatcher;
+	bool historyPacking = false;
+	void commitEdit();
+	void packHistory();
+	void restored(QRect area, bool background);
 
 	bool freeDrawActivated = false;
+	bool sourceLoading = false;
 	QPoint freeDrawBegin = QPoint(0, 0);
 
+	//rozkreslena ciara sa do obrazka nakresli naraz az v paintEvent, prekresli sa len jej okolie
+	QPolygon pendingStroke;
+	QPen pendingPen;
+	QRect pendingRect;
+	void flushStrokes();
+
+	//cas prvej udalosti mysi, ktora este nie je nakreslena (Trace), -1 = ziadna
+	qint64 inputTime = -1;
+
 public:
 	ViewerWidget(QString viewerName, QSize imgSize, QWidget* parent = Q_NULLPTR);
 	~ViewerWidget();
 	void resizeWidget(QSize size);
 
 	//Image functions
-	bool setImage(const QImage& inputImg);
-	QImage* getImage() { return img; };
+	bool setImage(QImage inputImg);
+	//obsah sa cita zo zdroja az pri zobrazeni alebo kresleni
+	bool setSource(QSharedPointer<const ImageSource> source);
+	//vymena zdroja rovnakej velkosti (nahlad za cely obrazok), nakreslene zostane
+	bool replaceSource(QSharedPointer<const ImageSource> source);
+	QSharedPointer<const ImageSource> getSource() const { return canvas.getSource(); };
+	//kym sa v pozadi dekoduje cely obrazok, zobrazuje sa nahlad a kreslit sa neda
+	//(dlazdica by si skopirovala nahlad a po vymene zdroja by v obrazku ostala)
+	void setSourceLoading(bool state) { sourceLoading = state; }
+	bool isSourceLoading() { return sourceLoading; }
+	const TiledCanvas& getCanvas() { flushStrokes(); return canvas; };
+	//skopiruje src do obrazka na poziciu at
+	void write(const QImage& src, QPoint at = QPoint(0, 0));
 	bool isEmpty();
+	//udalost, po ktorej sa meria cas do najblizsieho paintEvent
+	void markInput() { if (inputTime < 0 && Trace::isEnabled()) inputTime = Trace::now(); }
 
 	//Draw functions
 	void freeDraw(QPoint end, QPen pen);
 	void setFreeDrawBegin(QPoint begin) { freeDrawBegin = begin; }
 	QPoint getFreeDrawBegin() { return freeDrawBegin; }
-	void setFreeDrawActivated(bool state) { freeDrawActivated = state; }
+	//koniec tahu (false) uzavrie krok historie
+	void setFreeDrawActivated(bool state);
 	bool getFreeDrawActivated() { return freeDrawActivated; }
 
 	//Get/Set functions
 	QString getName() { return name; }
 	void setName(QString newName) { name = newName; }
 
-	void setPainter() { painter = new QPainter(img); }
+	int getImgWidth() { return canvas.width(); };
+	int getImgHeight() { return canvas.height(); };
+	qint64 getCanvasBytes() { return canvas.getAllocatedBytes(); };
+	qint64 getHistoryBytes() { return history.getMemoryBytes(); };
 
-	int getImgWidth() { return img->width(); };
-	int getImgHeight() { return img->height(); };
+	//Zoom functions
+	int getZoomStep() { return zoomStep; }
+	void setZoomStep(int step);
+	qreal getZoom() { return pow(2.0, zoomStep / 2.0); }
+	//suradnice widgetu na suradnice obrazka a naopak
+	QPoint mapToImage(QPoint p);
+	QRect mapFromImage(QRect r);
 
 	void clear();
 
+	//Undo functions
+	bool undo();
+	bool redo();
+	void setHistoryBudget(qint64 memory, qint64 disk) { history.setBudget(memory, disk); }
+
 public slots:
 	void paintEvent(QPaintEvent* event) Q_DECL_OVERRIDE;
+
+private slots:
+	void pyramidBuilt();
+	void historyPacked();
 };
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include "Weld.h"
+#include "MeshIO.h"
+#include "Arena.h"
+#include "Trace.h"
+#include "Parallel.h"
+#include <cmath>
+
+// bunka mriezky ma v kazdej osi 21 bitov (posunute o 1, aby mali kluc aj susedia na okraji), kluc je presny
+static const int cellBits = 21;
+static const qint64 cellRange = (qint64(1) << (cellBits - 1));
+
+static quint64 cellKey(qint64 x, qint64 y, qint64 z)
+{
+	return quint64(x + 1) | (quint64(y + 1) << cellBits) | (quint64(z + 1) << (2 * cellBits));
+}
+
+// koren skupiny, cesta sa skracuje cestou
+static int findRoot(int* parent, int v)
+{
+	while (parent[v] != v) {
+		parent[v] = parent[parent[v]];
+		v = parent[v];
+	}
+	return v;
+}
+
+WeldResult weldVertices(QVector<double>& points, QVector<int>& faceStart, QVector<int>& faceIndices, double tolerance, int threads)
+{
+	TRACE_SCOPE("weldVertices");
+	WeldResult result;
+	int i, n = points.size() / 3;
+	if (n == 0 || !(tolerance > 0))
+		return result;
+
+	ScratchArena& arena = ScratchArena::forThread();
+	ScratchArena::Scope scope(arena);
+	const double* p = points.constData();
+	double tol2 = tolerance * tolerance;
+
+	//mriezka pokryva obal vrcholov s konecnymi suradnicami, ak by mala viac ako 2^20 buniek v osi, bunky sa zvacsia
+	double lo[3] = { 0, 0, 0 }, hi[3] = { 0, 0, 0 };
+	bool prazdny = true;
+	for (i = 0; i < n; i++) {
+		const double* v = p + 3 * i;
+		if (!std::isfinite(v[0]) || !std::isfinite(v[1]) || !std::isfinite(v[2]))
+			continue;
+		for (int k = 0; k < 3; k++) {
+			if (prazdny || v[k] < lo[k]) lo[k] = v[k];
+			if (prazdny || v[k] > hi[k]) hi[k] = v[k];
+		}
+		prazdny = false;
+	}
+	double rozsah = qMax(hi[0] - lo[0], qMax(hi[1] - lo[1], hi[2] - lo[2]));
+	double inv = 1.0 / qMax(tolerance, rozsah / double(cellRange - 1));
+
+	//1. bunka kazdeho vrcholu
+	quint64* key = arena.alloc<quint64>(n);
+	int kusy = parallelChunkCount(n, threads);
+	parallelChunks(n, kusy, [&](int, int od, int po) {
+		for (int v = od; v < po; v++) {
+			qint64 c[3];
+			for (int k = 0; k < 3; k++)
+				c[k] = qint64(qBound(0.0, (p[3 * v + k] - lo[k]) * inv, double(cellRange - 1)));
+			key[v] = cellKey(c[0], c[1], c[2]);
+		}
+	});
+
+	//2. obsadene bunky v poradi prveho vrcholu, vrcholy bunky v zozname podla indexu
+	ArenaHash cells(arena, n);
+	int* cellOf = arena.alloc<int>(n);
+	int pocetBuniek = 0;
+	for (i = 0; i < n; i++) {
+		int& c = cells.insert(key[i], pocetBuniek);
+		if (c == pocetBuniek)
+			pocetBuniek++;
+		cellOf[i] = c;
+	}
+	int* first = arena.allocFilled(pocetBuniek, -1);
+	int* next = arena.alloc<int>(n);
+	for (i = n - 1; i >= 0; i--) {
+		next[i] = first[cellOf[i]];
+		first[cellOf[i]] = i;
+	}
+
+	//3. blizke pary (a < b) paralelne po bunkach, susedne bunky sa hladaju raz za bunku, kazdy kus ma vlastny zoznam
+	kusy = parallelChunkCount(pocetBuniek, threads, 1024);
+	QVector<QVector<int>> pary(kusy);
+	parallelChunks(pocetBuniek, kusy, [&](int t, int od, int po) {
+		QVector<int>& out = pary[t];
+		for (int c = od; c < po; c++) {
+			quint64 k = key[first[c]];
+			qint64 x = qint64(k & (cellRange * 2 - 1)) - 1, y = qint64((k >> cellBits) & (cellRange * 2 - 1)) - 1, z = qint64(k >> (2 * cellBits)) - 1;
+			int susedia[27], m = 0;
+			for (int d = 0; d < 27; d++) {
+				int s = cells.value(cellKey(x + d % 3 - 1, y + d / 3 % 3 - 1, z + d / 9 - 1), -1);
+				if (s >= 0)
+					susedia[m++] = s;
+			}
+			for (int a = first[c]; a >= 0; a = next[a]) {
+				for (int j = 0; j < m; j++) {
+					for (int b = first[susedia[j]]; b >= 0; b = next[b]) {
+						if (b <= a)
+							continue;
+						double dx = p[3 * a] - p[3 * b], dy = p[3 * a + 1] - p[3 * b + 1], dz = p[3 * a + 2] - p[3 * b + 2];
+						if (dx * dx + dy * dy + dz * dz <= tol2) {
+							out.append(a);
+							out.append(b);
+						}
+					}
+				}
+			}
+		}
+	});
+
+	//4. skupiny, koren je vrchol s najmensim indexom
+	int* parent = arena.alloc<int>(n);
+	for (i = 0; i < n; i++)
+		parent[i] = i;
+	for (const QVector<int>& out : pary) {
+		for (int k = 0; k < out.size(); k += 2) {
+			int a = findRoot(parent, out[k]), b = findRoot(parent, out[k + 1]);
+			if (a < b)
+				parent[b] = a;
+			else if (b < a)
+				parent[a] = b;
+		}
+	}
+
+	//5. novy index vrcholu, zastupca je pred ostatnymi vrcholmi skupiny
+	int* remap = arena.alloc<int>(n);
+	int m = 0;
+	double* q = points.data();
+	for (i = 0; i < n; i++) {
+		int r = findRoot(parent, i);
+		if (r == i) {
+			for (int k = 0; k < 3; k++)
+				q[3 * m + k] = q[3 * i + k];
+			remap[i] = m++;
+		}
+		else
+			remap[i] = remap[r];
+	}
+	result.removedVertices = n - m;
+	if (result.removedVertices == 0)
+		return result;
+	points.resize(3 * m);
+
+	//6. steny s premapovanymi vrcholmi bez opakovanych susedov, degenerovane sa vynechaju
+	int stenySize = faceStart.size() - 1, f = 0, w = 0;
+	for (i = 0; i < stenySize; i++) {
+		int zaciatok = w;
+		for (int k = faceStart[i]; k < faceStart[i + 1]; k++) {
+			int v = uint(faceIndices[k]) < uint(n) ? remap[faceIndices[k]] : faceIndices[k];
+			if (w == zaciatok || faceIndices[w - 1] != v)
+				faceIndices[w++] = v;
+		}
+		while (w - zaciatok > 1 && faceIndices[w - 1] == faceIndices[zaciatok])
+			w--;
+		if (w - zaciatok < 3 && faceStart[i + 1] - faceStart[i] >= 3) {
+			w = zaciatok;
+			result.removedFaces++;
+			continue;
+		}
+		faceStart[f++] = zaciatok;
+	}
+	faceStart[f] = w;
+	faceStart.resize(f + 1);
+	faceIndices.resize(w);
+	return result;
+}
+
+Hedron weldMesh(const Hedron& mesh, double tolerance, QString* error, JobProgress* progress, WeldResult* result)
+{
+	TRACE_SCOPE("weldMesh");
+	int i, vrcholySize = mesh.getVrcholysize(), stenySize = mesh.getStenysize();
+	QVector<double> points(3 * vrcholySize);
+	for (i = 0; i < vrcholySize; i++) {
+		points[3 * i] = mesh.x(i);
+		points[3 * i + 1] = mesh.y(i);
+		points[3 * i + 2] = mesh.z(i);
+	}
+	QVector<int> faceStart, faceIndices;
+	faceStart.reserve(stenySize + 1);
+	faceIndices.reserve(mesh.getHranysize());
+	for (i = 0; i < stenySize; i++) {
+		faceStart.append(faceIndices.size());
+		int h = mesh.faceEdge(i);
+		do {
+			faceIndices.append(mesh.origin(h));
+			h = mesh.next(h);
+		} while (h != mesh.faceEdge(i) && faceIndices.size() - faceStart.last() <= mesh.getHranysize());
+	}
+	faceStart.append(faceIndices.size());
+
+	WeldResult zvarene = weldVertices(points, faceStart, faceIndices, tolerance);
+	if (result)
+		*result = zvarene;
+	if (jobCancelled(progress)) {
+		if (error)
+			*error = jobCancelledText;
+		return Hedron();
+	}
+	return buildHedron(points, faceStart, faceIndices, error, progress);
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <QtCore>
+#include "Objekt.h"
+#include "Job.h"
+
+// zvaranie vrcholov blizsich ako tolerance (zdvojene vrcholy na svoch v sietach z inych programov)
+// rovnomerna mriezka s bunkou velkosti tolerance v hashovacej tabulke, vrchol sa porovnava len s vrcholmi v 27 susednych bunkach, O(V)
+// blizke pary sa hladaju paralelne po bunkach, skupiny (aj retazce blizkych vrcholov) spoji union-find
+// skupinu nahradi vrchol s najmensim indexom, zvarene vrcholy maju poradie svojich zastupcov, vysledok nezavisi od poctu vlakien
+
+struct WeldResult {
+	int removedVertices = 0;
+	int removedFaces = 0;		// steny, z ktorych po zvareni ostali menej ako 3 rozne vrcholy
+};
+
+// polia v tvare pre buildHedron, upravia sa na mieste: points sa zmensia, indexy stien sa premapuju,
+// opakovane susedne vrcholy steny sa vynechaju; tolerance <= 0 nic nezmeni
+WeldResult weldVertices(QVector<double>& points, QVector<int>& faceStart, QVector<int>& faceIndices, double tolerance, int threads = QThread::idealThreadCount());
+
+// zvarena kopia siete, topologia sa zostavi znovu cez buildHedron; pri chybe prazdny Hedron
+Hedron weldMesh(const Hedron& mesh, double tolerance, QString* error = nullptr, JobProgress* progress = nullptr, WeldResult* result = nullptr);
@@ -0,0 +1,303 @@
+// benchmark horucich ciest siete a platna bez okna, vysledky ako JSON
+// bench [--quick] [--repeat n] [--filter text] [--output file]
+// vstupy su generovane (geodeticka sfera, mriezka ako VTK, nahodna ciara so stalym seedom), beh je opakovatelny
+#include <QtWidgets>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "MeshIO.h"
+#include "Subdivision.h"
+#include "Rasterizer.h"
+#include "ViewerWidget.h"
+
+// pocitadlo alokacii: s glibc sa zachyti malloc (aj QVector, QImage), inak len operator new
+static std::atomic<qint64> allocCount(0), allocBytes(0);
+
+#if defined(__GLIBC__)
+extern "C" {
+	void* __libc_malloc(size_t n);
+	void* __libc_calloc(size_t n, size_t size);
+	void* __libc_realloc(void* p, size_t n);
+	void __libc_free(void* p);
+
+	void* malloc(size_t n)
+	{
+		allocCount++;
+		allocBytes += n;
+		return __libc_malloc(n);
+	}
+	void* calloc(size_t n, size_t size)
+	{
+		allocCount++;
+		allocBytes += n * size;
+		return __libc_calloc(n, size);
+	}
+	void* realloc(void* p, size_t n)
+	{
+		allocCount++;
+		allocBytes += n;
+		return __libc_realloc(p, n);
+	}
+	void free(void* p)
+	{
+		__libc_free(p);
+	}
+}
+#else
+void* operator new(size_t n)
+{
+	allocCount++;
+	allocBytes += n;
+	if (void* p = std::malloc(n ? n : 1))
+		return p;
+	throw std::bad_alloc();
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+#endif
+
+class Bench {
+	int repeat;
+	QString filter;
+	QJsonArray results;
+public:
+	Bench(int repeatCount, QString filterText) : repeat(qMax(1, repeatCount)), filter(filterText) {};
+	bool enabled(const QString& name) const { return filter.isEmpty() || name.contains(filter); };
+	// sekcia sa pripravuje, len ak filtru vyhovuje niektore z jej merani
+	bool anyEnabled(const QStringList& names) const {
+		for (const QString& name : names)
+			if (enabled(name)) return true;
+		return false;
+	};
+	QJsonArray getResults() const { return results; };
+
+	// setup sa do casu nezapocita, items / s sa pocita z medianu
+	void run(QString name, QJsonObject params, qint64 items, QString unit, std::function<void()> setup, std::function<void()> op);
+};
+
+void Bench::run(QString name, QJsonObject params, qint64 items, QString unit, std::function<void()> setup, std::function<void()> op)
+{
+	if (!enabled(name))
+		return;
+	QVector<qint64> casy;
+	qint64 allocs = 0, bytes = 0;
+	for (int r = 0; r < repeat; r++) {
+		if (setup)
+			setup();
+		qint64 a0 = allocCount, b0 = allocBytes;
+		QElapsedTimer timer;
+		timer.start();
+		op();
+		casy.append(timer.nsecsElapsed());
+		allocs = allocCount - a0;
+		bytes = allocBytes - b0;
+	}
+	std::sort(casy.begin(), casy.end());
+	double sucet = 0;
+	for (qint64 c : casy)
+		sucet += c;
+	double median = casy.size() % 2 ? casy[casy.size() / 2] : 0.5 * (casy[casy.size() / 2 - 1] + casy[casy.size() / 2]);
+
+	QJsonObject o;
+	o["name"] = name;
+	o["params"] = params;
+	o["repeat"] = repeat;
+	o["min_ms"] = casy.first() / 1e6;
+	o["median_ms"] = median / 1e6;
+	o["mean_ms"] = sucet / casy.size() / 1e6;
+	o["items"] = double(items);
+	o["unit"] = unit;
+	o["items_per_s"] = median > 0 ? items / (median / 1e9) : 0.0;
+	o["allocs"] = double(allocs);
+	o["alloc_bytes"] = double(bytes);
+	results.append(o);
+	QTextStream(stderr) << name << " " << QJsonDocument(params).toJson(QJsonDocument::Compact) << " " << median / 1e6 << " ms, " << allocs << " alloc\n";
+}
+
+// mriezka sirka x vyska stvorcov, kazdy na dva trojuholniky, so zvlnenou vyskou
+static Hedron gridMesh(int faces)
+{
+	int w = qMax(1, int(ceil(sqrt(faces / 2.0)))), h = qMax(1, (faces / 2 + w - 1) / w);
+	QVector<double> points;
+	QVector<int> faceStart, faceIndices;
+	points.reserve(3 * (w + 1) * (h + 1));
+	for (int j = 0; j <= h; j++) {
+		for (int i = 0; i <= w; i++) {
+			points.append(double(i) / w);
+			points.append(double(j) / h);
+			points.append(0.05 * sin(i * 0.3) * cos(j * 0.2));
+		}
+	}
+	faceStart.reserve(2 * w * h + 1);
+	faceIndices.reserve(6 * w * h);
+	for (int j = 0; j < h; j++) {
+		for (int i = 0; i < w; i++) {
+			int a = j * (w + 1) + i, b = a + 1, c = a + w + 1, d = c + 1;
+			faceStart.append(faceIndices.size());
+			faceIndices << a << b << d;
+			faceStart.append(faceIndices.size());
+			faceIndices << a << d << c;
+		}
+	}
+	faceStart.append(faceIndices.size());
+	return buildHedron(points, faceStart, faceIndices);
+}
+
+int main(int argc, char* argv[])
+{
+	//ViewerWidget potrebuje QApplication, kresli sa len do QImage
+	if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+	QLocale::setDefault(QLocale::c());
+	QApplication app(argc, argv);
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Benchmark siete a platna, vysledky ako JSON.");
+	parser.addHelpOption();
+	QCommandLineOption quickOption("quick", "Mensie vstupy (siet do urovne 7, VTK do 100k stien, platno do 4096).");
+	QCommandLineOption repeatOption("repeat", "Pocet opakovani kazdeho merania.", "n", "5");
+	QCommandLineOption filterOption("filter", "Len merania, ktorych nazov obsahuje text.", "text");
+	QCommandLineOption outputOption("output", "Subor pre JSON (inak standardny vystup).", "file");
+	parser.addOptions({ quickOption, repeatOption, filterOption, outputOption });
+	parser.process(app);
+
+	bool quick = parser.isSet(quickOption);
+	Bench bench(parser.value(repeatOption).toInt(), parser.value(filterOption));
+	QTemporaryDir tmp;
+	if (!tmp.isValid()) {
+		QTextStream(stderr) << "Nepodarilo sa vytvorit docasny adresar.\n";
+		return 1;
+	}
+
+	//siet: generovanie, delenie (on_rozdel_clicked), parovanie polohran
+	int maxLevel = bench.anyEnabled({ "octa/generate", "octa/subdivide", "hedron/setParove" }) ? (quick ? 7 : 9) : 0;
+	for (int level = 1; level <= maxLevel; level++) {
+		QJsonObject params{ { "level", level } };
+		qint64 faces = 8LL << (2 * level);
+		Hedron result;
+		bench.run("octa/generate", params, faces, "faces", [&]() { result = Hedron(); }, [&]() { result = geodesicSphere(level); });
+
+		if (bench.enabled("octa/subdivide")) {
+			Hedron parent = geodesicSphere(level - 1);
+			bench.run("octa/subdivide", params, faces, "faces", [&]() { result = Hedron(); }, [&]() { result = subdivide(parent); });
+		}
+
+		if (bench.enabled("hedron/setParove")) {
+			Hedron mesh = geodesicSphere(level);
+			Hedron copy;
+			bench.run("hedron/setParove", params, mesh.getHranysize(), "half-edges", [&]() { copy = mesh; }, [&]() { copy.setParove(); });
+		}
+	}
+
+	//import a export (on_imp_clicked, on_exp_clicked) na mriezkach
+	QVector<int> sizes = { 1000, 10000, 100000 };
+	if (!quick)
+		sizes << 1000000 << 10000000;
+	if (!bench.anyEnabled({ "vtk/export", "vtk/import", "hed/export", "hed/import" }))
+		sizes.clear();
+	for (int faces : sizes) {
+		Hedron mesh = gridMesh(faces);
+		for (int binary = 0; binary < 2; binary++) {
+			QJsonObject params{ { "faces", mesh.getStenysize() }, { "binary", bool(binary) } };
+			QString fileName = tmp.filePath(QString("grid%1%2.vtk").arg(faces).arg(binary ? "b" : "a"));
+			bench.run("vtk/export", params, mesh.getStenysize(), "faces", nullptr, [&]() { exportVtk(mesh, fileName, binary); });
+			if (bench.enabled("vtk/import") && !QFile::exists(fileName))
+				exportVtk(mesh, fileName, binary);
+			Hedron imported;
+			bench.run("vtk/import", params, mesh.getStenysize(), "faces", [&]() { imported = Hedron(); }, [&]() { imported = importMesh(fileName); });
+			QFile::remove(fileName);
+		}
+		QJsonObject params{ { "faces", mesh.getStenysize() } };
+		QString fileName = tmp.filePath(QString("grid%1.hed").arg(faces));
+		bench.run("hed/export", params, mesh.getStenysize(), "faces", nullptr, [&]() { exportNative(mesh, fileName); });
+		if (bench.enabled("hed/import") && !QFile::exists(fileName))
+			exportNative(mesh, fileName);
+		Hedron imported;
+		bench.run("hed/import", params, mesh.getStenysize(), "faces", [&]() { imported = Hedron(); }, [&]() { imported = importMesh(fileName); });
+		QFile::remove(fileName);
+	}
+
+	//platno: 1000 usekov nahodnej ciary cez freeDraw a vykreslenie vyrezu 1920 x 1080 cez paintEvent
+	QVector<int> canvases = { 1024, 2048, 4096 };
+	if (!quick)
+		canvases << 8192 << 16384;
+	if (!bench.anyEnabled({ "canvas/freeDraw", "canvas/paintEvent" }))
+		canvases.clear();
+	for (int s : canvases) {
+		QJsonObject params{ { "size", s } };
+		std::unique_ptr<ViewerWidget> w;
+		QVector<QPoint> body;
+		quint32 seed = 12345;
+		QPoint p(s / 2, s / 2);
+		for (int k = 0; k <= 1000; k++) {
+			seed = seed * 1664525u + 1013904223u;
+			p += QPoint(int(seed >> 24) % 41 - 20, int((seed >> 16) & 0xFF) % 41 - 20);
+			p = QPoint(qBound(0, p.x(), s - 1), qBound(0, p.y(), s - 1));
+			body.append(p);
+		}
+		auto kresli = [&]() {
+			for (int k = 1; k < body.size(); k++) {
+				w->setFreeDrawBegin(body[k - 1]);
+				w->freeDraw(body[k], QPen(Qt::red));
+			}
+			w->getCanvas();
+		};
+		bench.run("canvas/freeDraw", params, body.size() - 1, "segments", [&]() { w.reset(new ViewerWidget("bench", QSize(s, s))); }, kresli);
+
+		QRect vyrez(0, 0, qMin(s, 1920), qMin(s, 1080));
+		vyrez.moveCenter(QPoint(s / 2, s / 2));
+		QImage ciel(vyrez.size(), QImage::Format_ARGB32);
+		//vykresluje sa platno s ciarou, aj ked sa freeDraw nemeral
+		if (!w && bench.enabled("canvas/paintEvent")) {
+			w.reset(new ViewerWidget("bench", QSize(s, s)));
+			kresli();
+		}
+		bench.run("canvas/paintEvent", params, qint64(vyrez.width()) * vyrez.height(), "pixels", nullptr, [&]() { w->render(&ciel, QPoint(), QRegion(vyrez)); });
+	}
+
+	//rasterizer podla poctu vlakien, snimky pri otacani kamery (normaly uz su v cache)
+	if (bench.enabled("rasterizer/render")) {
+		Hedron mesh = geodesicSphere(7);
+		QImage frame(1280, 720, QImage::Format_ARGB32);
+		Camera camera;
+		QVector<int> threads = { 1 };
+		for (int t = 2; t < QThread::idealThreadCount(); t *= 2)
+			threads << t;
+		if (QThread::idealThreadCount() > 1)
+			threads << QThread::idealThreadCount();
+		for (int t : threads) {
+			Rasterizer rasterizer(t);
+			rasterizer.render(mesh, camera, frame);
+			QJsonObject params{ { "level", 7 }, { "threads", t }, { "width", frame.width() }, { "height", frame.height() } };
+			bench.run("rasterizer/render", params, mesh.getStenysize(), "faces", [&]() { camera.azimuth += 1.0f; }, [&]() { rasterizer.render(mesh, camera, frame); });
+		}
+	}
+
+	QJsonObject doc;
+	doc["suite"] = "imageviewer-bench";
+	doc["version"] = 1;
+	doc["qt"] = qVersion();
+	doc["ideal_threads"] = QThread::idealThreadCount();
+	doc["quick"] = quick;
+#if defined(__GLIBC__)
+	doc["allocs_counted"] = "malloc";
+#else
+	doc["allocs_counted"] = "operator new";
+#endif
+	doc["results"] = bench.getResults();
+	QByteArray json = QJsonDocument(doc).toJson(QJsonDocument::Indented);
+	if (parser.isSet(outputOption)) {
+		QFile file(parser.value(outputOption));
+		if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size()) {
+			QTextStream(stderr) << "Nepodarilo sa zapisat " << parser.value(outputOption) << "\n";
+			return 1;
+		}
+	}
+	else {
+		QTextStream(stdout) << json;
+	}
+	return 0;
+}
@@ -1,5 +1,6 @@
 #include "ImageViewer.h"
 #include <QtWidgets/QApplication>
+#include "Batch.h"
 
 int main(int argc, char* argv[])
 {
@@ -8,6 +9,12 @@ int main(int argc, char* argv[])
 	QCoreApplication::setOrganizationName("MPM");
 	QCoreApplication::setApplicationName("ImageViewer");
 
+	//davkovy rezim nepotrebuje okno ani displej
+	if (isBatchMode(argc, argv)) {
+		QCoreApplication a(argc, argv);
+		return runBatch(a.arguments());
+	}
+
 	QApplication a(argc, argv);
 	ImageViewer w;
 	w.show();
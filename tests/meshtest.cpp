@@ -0,0 +1,128 @@
+// kontroly siete bez okna: konzistencia polohran, nezavislost delenia a zvarania od poctu vlakien, geodeticka sfera ako delenie
+// meshtest vrati 0, ak presli vsetky kontroly, inak vypise zlyhane a vrati 1
+#include <QtCore>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include "Subdivision.h"
+#include "MeshIO.h"
+#include "Weld.h"
+
+static int chyby = 0;
+
+static void check(bool ok, const QString& text)
+{
+	if (!ok) {
+		QTextStream(stderr) << "FAIL " << text << "\n";
+		chyby++;
+	}
+}
+
+// pary polohran su navzajom parove, par zacina tam, kde polohrana konci
+static bool twinsConsistent(const Hedron& mesh)
+{
+	for (int h = 0; h < mesh.getHranysize(); h++) {
+		int t = mesh.twin(h);
+		if (t == -1)
+			continue;
+		if (t < 0 || t >= mesh.getHranysize() || mesh.twin(t) != h || mesh.origin(t) != mesh.dest(h))
+			return false;
+	}
+	return true;
+}
+
+// vsetky polia siete su zhodne (bajt po bajte pre double aj int)
+static bool sameMesh(const Hedron& a, const Hedron& b)
+{
+	return a.arrayX() == b.arrayX() && a.arrayY() == b.arrayY() && a.arrayZ() == b.arrayZ()
+		&& a.arrayVertexEdge() == b.arrayVertexEdge() && a.arrayOrigin() == b.arrayOrigin()
+		&& a.arrayNext() == b.arrayNext() && a.arrayPrev() == b.arrayPrev() && a.arrayTwin() == b.arrayTwin()
+		&& a.arrayFace() == b.arrayFace() && a.arrayFaceEdge() == b.arrayFaceEdge();
+}
+
+// delenie v jednom a viacerych vlaknach (uroven 6 ma 32768 stien, teda 8 kusov po 4096)
+static void testSubdivide()
+{
+	Hedron mesh = Hedron::octahedron();
+	check(twinsConsistent(mesh), "octahedron: twin");
+	SubdivisionEngine jedno(1), viac(8);
+	for (int level = 1; level <= 7; level++) {
+		Hedron a = jedno.subdivide(mesh), b = viac.subdivide(mesh);
+		check(!a.HisEmpty() && twinsConsistent(a), QString("subdivide %1: twin").arg(level));
+		check(a.getBoundaryCount() == 0 && a.getNonManifoldCount() == 0, QString("subdivide %1: uzavreta").arg(level));
+		check(sameMesh(a, b), QString("subdivide %1: 1 a 8 vlakien").arg(level));
+		mesh = a;
+	}
+}
+
+// steny ako trojice poloh vrcholov, otocene tak, aby zacinali najmensou (orientacia sa zachova), zoradene
+static std::vector<std::array<double, 9>> faceGeometry(const Hedron& mesh)
+{
+	std::vector<std::array<double, 9>> steny;
+	for (int f = 0; f < mesh.getStenysize(); f++) {
+		std::array<std::array<double, 3>, 3> v;
+		int h = mesh.faceEdge(f);
+		for (int k = 0; k < 3; k++, h = mesh.next(h))
+			v[k] = { mesh.x(mesh.origin(h)), mesh.y(mesh.origin(h)), mesh.z(mesh.origin(h)) };
+		std::rotate(v.begin(), std::min_element(v.begin(), v.end()), v.end());
+		steny.push_back({ v[0][0], v[0][1], v[0][2], v[1][0], v[1][1], v[1][2], v[2][0], v[2][1], v[2][2] });
+	}
+	std::sort(steny.begin(), steny.end());
+	return steny;
+}
+
+// geodeticka sfera ma rovnake polohy vrcholov a steny ako opakovane delenie, len v inom poradi
+static void testGeodesicSphere()
+{
+	Hedron delene = Hedron::octahedron();
+	for (int level = 0; level <= 6; level++) {
+		if (level > 0)
+			delene = subdivide(delene);
+		Hedron sfera = geodesicSphere(level);
+		check(twinsConsistent(sfera), QString("geodesicSphere %1: twin").arg(level));
+		check(sfera.getVrcholysize() == delene.getVrcholysize() && sfera.getStenysize() == delene.getStenysize(),
+			QString("geodesicSphere %1: pocty").arg(level));
+		check(faceGeometry(sfera) == faceGeometry(delene), QString("geodesicSphere %1: steny ako subdivide").arg(level));
+	}
+	QString error;
+	check(geodesicSphere(geodesicMaxLevel + 1, &error).HisEmpty() && !error.isEmpty(), "geodesicSphere: uroven mimo rozsahu");
+}
+
+// polievka trojuholnikov (kazda stena ma vlastne kopie vrcholov, posunute o menej ako tolerancia)
+// sa zvari spat na uzavretu sferu, v jednom aj viacerych vlaknach rovnako
+static void testWeld()
+{
+	Hedron sfera = geodesicSphere(6);
+	QVector<double> points;
+	QVector<int> faceStart, faceIndices;
+	for (int f = 0; f < sfera.getStenysize(); f++) {
+		faceStart.append(faceIndices.size());
+		int h = sfera.faceEdge(f);
+		for (int k = 0; k < 3; k++, h = sfera.next(h)) {
+			int v = sfera.origin(h), n = faceIndices.size();
+			double posun = 1e-9 * (n % 5);
+			points << sfera.x(v) + posun << sfera.y(v) - posun << sfera.z(v) + posun;
+			faceIndices.append(n);
+		}
+	}
+	faceStart.append(faceIndices.size());
+
+	QVector<double> p1 = points, p8 = points;
+	QVector<int> s1 = faceStart, s8 = faceStart, i1 = faceIndices, i8 = faceIndices;
+	WeldResult r1 = weldVertices(p1, s1, i1, 1e-7, 1), r8 = weldVertices(p8, s8, i8, 1e-7, 8);
+	check(p1 == p8 && s1 == s8 && i1 == i8 && r1.removedVertices == r8.removedVertices, "weld: 1 a 8 vlakien");
+	check(r1.removedVertices == points.size() / 3 - sfera.getVrcholysize() && r1.removedFaces == 0, "weld: pocet zvarenych");
+	Hedron zvarene = buildHedron(p1, s1, i1);
+	check(!zvarene.HisEmpty() && twinsConsistent(zvarene), "weld: twin");
+	check(zvarene.getBoundaryCount() == 0 && zvarene.getNonManifoldCount() == 0, "weld: uzavreta");
+}
+
+int main()
+{
+	testSubdivide();
+	testGeodesicSphere();
+	testWeld();
+	if (chyby == 0)
+		QTextStream(stdout) << "meshtest: OK\n";
+	return chyby == 0 ? 0 : 1;
+}